@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <functional>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hello_triangle_application.h"
+#include "utils/app_config.h"
+#include "utils/timing_stats.h"
+
+// Runs fixed set of headless scenarios and prints results as JSON, so CI can compare them between builds.
+//
+//   hello_vulkan_bench [--frames N] [--scenario NAME]... [--output PATH] [--verbose] [--list]
+
+struct Scenario
+{
+    std::string name;
+    std::function<void(AppConfig &)> configure;
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    bool succeeded = false;
+    std::string error;
+
+    double initTime = 0.0;
+    double fps = 0.0;
+    TimingStats frameTimes;
+};
+
+static std::vector<Scenario> getScenarios()
+{
+    uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    return {
+            {"baseline",           [](AppConfig &) {}},
+            {"triangles-10k",      [](AppConfig &config) { config.triangleCount = 10000; }},
+            {"triangles-100k",     [](AppConfig &config) { config.triangleCount = 100000; }},
+            {"draws-1k",           [](AppConfig &config) { config.drawCount = 1000; }},
+            {"draws-10k",          [](AppConfig &config) { config.drawCount = 10000; }},
+            {"draws-10k-parallel", [hardwareThreads](AppConfig &config)
+                                   {
+                                       config.drawCount = 10000;
+                                       config.recordThreads = hardwareThreads;
+                                   }},
+            {"pipelines-16",       [](AppConfig &config)
+                                   {
+                                       config.pipelineCount = 16;
+                                       config.drawCount = 16;
+                                   }},
+            {"pipelines-64",       [](AppConfig &config)
+                                   {
+                                       config.pipelineCount = 64;
+                                       config.drawCount = 64;
+                                   }},
+            {"frames-in-flight-1", [](AppConfig &config) { config.framesInFlight = 1; }},
+            {"frames-in-flight-2", [](AppConfig &config) { config.framesInFlight = 2; }},
+            {"frames-in-flight-3", [](AppConfig &config) { config.framesInFlight = 3; }},
+            {"bindless",           [](AppConfig &config) { config.bindless = true; }},
+            {"instances-100k-per-object", [](AppConfig &config)
+                                          {
+                                              config.instanceCount = 100000;
+                                              config.drawMode = DrawMode::PerObject;
+                                          }},
+            {"instances-100k-instanced", [](AppConfig &config)
+                                         {
+                                             config.instanceCount = 100000;
+                                             config.drawMode = DrawMode::Instanced;
+                                         }},
+            {"instances-100k-indirect", [](AppConfig &config)
+                                        {
+                                            config.instanceCount = 100000;
+                                            config.drawMode = DrawMode::Indirect;
+                                        }},
+            {"instances-100k-indirect-zoom-4", [](AppConfig &config)
+                                               {
+                                                   config.instanceCount = 100000;
+                                                   config.drawMode = DrawMode::Indirect;
+                                                   config.zoom = 4;
+                                               }},
+            {"instances-100k-gpu-culled-zoom-4", [](AppConfig &config)
+                                                 {
+                                                     config.instanceCount = 100000;
+                                                     config.drawMode = DrawMode::Indirect;
+                                                     config.gpuCulling = true;
+                                                     config.zoom = 4;
+                                                 }},
+            {"particles-100k-async-compute", [](AppConfig &config)
+                                             {
+                                                 config.instanceCount = 100000;
+                                                 config.particles = true;
+                                             }},
+            {"particles-100k-graphics-queue", [](AppConfig &config)
+                                              {
+                                                  config.instanceCount = 100000;
+                                                  config.particles = true;
+                                                  config.asyncCompute = false;
+                                              }}
+    };
+}
+
+static ScenarioResult runScenario(const Scenario &scenario, uint32_t frameCount)
+{
+    ScenarioResult result;
+    result.name = scenario.name;
+
+    AppConfig config;
+    config.headless = true;
+    config.frameLimit = frameCount;
+    config.framesInFlight = 2;
+
+    // Every scenario starts cold and leaves nothing behind for the next one
+    config.pipelineCachePath.clear();
+
+    scenario.configure(config);
+
+    try
+    {
+        HelloTriangleApplication app(config);
+        app.run();
+
+        const auto &stats = app.getRunStats();
+
+        result.initTime = stats.initTime;
+        result.frameTimes = computeTimingStats(stats.frameTimes);
+        if (stats.mainLoopTime > 0.0)
+            result.fps = stats.frameTimes.size() * 1000.0 / stats.mainLoopTime;
+
+        result.succeeded = true;
+    }
+    catch (const std::exception &e)
+    {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+static void writeJson(std::ostream &out, uint32_t frameCount, const std::vector<ScenarioResult> &results)
+{
+    out << "{\n  \"frames\": " << frameCount << ",\n  \"scenarios\": [";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto &result = results[i];
+
+        out << (i == 0 ? "" : ",") << "\n    {\"name\": \"" << result.name << "\", ";
+
+        if (!result.succeeded)
+        {
+            out << "\"error\": \"" << escapeJson(result.error) << "\"}";
+            continue;
+        }
+
+        out << "\"init_ms\": " << result.initTime
+            << ", \"fps\": " << result.fps
+            << ", \"frame_ms\": {\"average\": " << result.frameTimes.average
+            << ", \"p50\": " << result.frameTimes.p50
+            << ", \"p99\": " << result.frameTimes.p99
+            << ", \"max\": " << result.frameTimes.max << "}}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frameCount = 300;
+    std::vector<std::string> selected;
+    std::string outputPath;
+    bool verbose = false;
+
+    auto scenarios = getScenarios();
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (option == "--frames" && hasValue)
+        {
+            try
+            {
+                frameCount = parseUnsigned(option, argv[++i]);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            if (frameCount == 0)
+            {
+                std::cerr << "--frames must be a positive number!" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (option == "--scenario" && hasValue)
+        {
+            selected.emplace_back(argv[++i]);
+        }
+        else if (option == "--output" && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else if (option == "--verbose")
+        {
+            verbose = true;
+        }
+        else if (option == "--list")
+        {
+            for (const auto &scenario : scenarios)
+                std::cout << scenario.name << std::endl;
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            std::cerr << "unknown or incomplete option " << option << "!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Typo in a CI script must not pass as a run of nothing
+    for (const auto &name : selected)
+    {
+        if (std::none_of(scenarios.begin(), scenarios.end(),
+                         [&name](const Scenario &scenario) { return scenario.name == name; }))
+        {
+            std::cerr << "unknown scenario " << name << ", see --list!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<ScenarioResult> results;
+    bool failed = false;
+
+    for (const auto &scenario : scenarios)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), scenario.name) == selected.end())
+            continue;
+
+        std::cerr << "Running " << scenario.name << "..." << std::endl;
+
+        // Application log would corrupt JSON on stdout, so it is either moved to stderr or dropped.
+        // Restoring buffer clears error state left by writing into null one.
+        std::streambuf *coutBuffer = std::cout.rdbuf(verbose ? std::cerr.rdbuf() : nullptr);
+        results.push_back(runScenario(scenario, frameCount));
+        std::cout.rdbuf(coutBuffer);
+
+        if (!results.back().succeeded)
+        {
+            std::cerr << scenario.name << " failed: " << results.back().error << std::endl;
+            failed = true;
+        }
+    }
+
+    if (outputPath.empty())
+    {
+        writeJson(std::cout, frameCount, results);
+    }
+    else
+    {
+        std::ofstream file(outputPath);
+        if (!file.is_open())
+        {
+            std::cerr << "failed to open " << outputPath << "!" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        writeJson(file, frameCount, results);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+# Writes C++ source with every SPIR-V file as constexpr uint32_t array and a table to look them up by file name.
+#
+#   cmake -DOUTPUT=embedded_shaders_data.cpp -DSPIRV_FILES="vert.spv|frag.spv" -P embed_spirv.cmake
+#
+# Files are separated by "|", since ";" doesn't survive being passed through custom command arguments.
+
+string(REPLACE "|" ";" spirv_files "${SPIRV_FILES}")
+
+# Eight words per line, CMake regular expressions have no {n} repetition
+string(REPEAT "0x[0-9a-f]+," 8 line_pattern)
+
+set(arrays "")
+set(entries "")
+
+foreach(spirv_file ${spirv_files})
+    get_filename_component(name ${spirv_file} NAME)
+    string(MAKE_C_IDENTIFIER "${name}" identifier)
+
+    file(READ ${spirv_file} hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR remainder "${hex_length} % 8")
+    if (hex_length EQUAL 0 OR NOT remainder EQUAL 0)
+        message(FATAL_ERROR "${spirv_file} is not a SPIR-V binary, size is not a multiple of 4 bytes")
+    endif()
+
+    # SPIR-V words are little endian in file, so bytes of each word are reversed into a hex literal
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," words "${hex}")
+    string(REGEX REPLACE "(${line_pattern})" "\\1\n        " words "${words}")
+
+    string(APPEND arrays "alignas(16) static constexpr uint32_t ${identifier}[] =\n")
+    string(APPEND arrays "        {\n        ${words}\n        };\n\n")
+    string(APPEND entries "        {\"${name}\", ${identifier}, sizeof(${identifier})},\n")
+endforeach()
+
+# Always rewritten, an output older than its inputs would keep the custom command out of date forever
+file(WRITE ${OUTPUT}
+        "// Generated by cmake/embed_spirv.cmake, do not edit\n"
+        "#include \"utils/embedded_shaders.h\"\n"
+        "\n"
+        "${arrays}"
+        "const EmbeddedShader EMBEDDED_SHADERS[] =\n"
+        "        {\n"
+        "${entries}"
+        "        {nullptr, nullptr, 0}\n"
+        "        };\n")
@@ -1,9 +1,13 @@
 @echo off
+rem Regular builds embed shaders, this is for iterating on them: run the app with --shader-dir cmake-build-debug/shaders
 set glslc_exe=%1
 
 md "./cmake-build-debug/shaders"
 
 %glslc_exe% ./src/shaders/shader.vert -o ./cmake-build-debug/shaders/vert.spv
+%glslc_exe% ./src/shaders/shader_bindless.vert -o ./cmake-build-debug/shaders/vert_bindless.spv
 %glslc_exe% ./src/shaders/shader.frag -o ./cmake-build-debug/shaders/frag.spv
+%glslc_exe% ./src/shaders/cull.comp -o ./cmake-build-debug/shaders/cull.spv
+%glslc_exe% ./src/shaders/particles.comp -o ./cmake-build-debug/shaders/particles.spv
 
 echo shaders compiled
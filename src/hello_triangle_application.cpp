@@ -0,0 +1,2225 @@
+#include "hello_triangle_application.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+#include "utils/vk_debug.h"
+#include "utils/embedded_shaders.h"
+#include "utils/cpu_profiler.h"
+#include "utils/timing_stats.h"
+#include "utils/device_selector.h"
+
+HelloTriangleApplication::HelloTriangleApplication(const AppConfig &config) :
+        config(config),
+        allocationCallbacks(config.defaultHostAllocator ? nullptr : hostAllocator.getCallbacks())
+{
+    generateGeometry();
+    generateInstances();
+}
+
+void HelloTriangleApplication::run()
+{
+    if (!config.cpuProfilePath.empty())
+    {
+        CpuProfiler::setEnabled(true);
+        CpuProfiler::setThreadName("main");
+    }
+
+    auto initStartTime = std::chrono::steady_clock::now();
+    runStartTime = initStartTime;
+
+    if (!config.headless)
+        initWindow();
+
+    initVulkan();
+
+    std::chrono::duration<double, std::milli> initTime = std::chrono::steady_clock::now() - initStartTime;
+    runStats.initTime = initTime.count();
+
+    if (config.recordingBenchmark)
+        runRecordingBenchmark();
+    else
+        mainLoop();
+
+    cleanup();
+
+    if (!config.cpuProfilePath.empty())
+    {
+        size_t zoneCount = CpuProfiler::exportChromeTrace(config.cpuProfilePath);
+        std::cout << "Wrote " << zoneCount << " CPU zones to " << config.cpuProfilePath << std::endl;
+    }
+}
+
+void HelloTriangleApplication::initWindow()
+{
+    CpuZone zone("initWindow");
+
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+    window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+}
+
+void HelloTriangleApplication::framebufferResizeCallback(GLFWwindow *window, int width, int height)
+{
+    auto app = reinterpret_cast<HelloTriangleApplication *>(glfwGetWindowUserPointer(window));
+    app->framebufferResized = true;
+}
+
+void HelloTriangleApplication::initVulkan()
+{
+    CpuZone zone("initVulkan");
+
+    threadPool = std::make_unique<ThreadPool>(config.workerThreads);
+
+    createInstance();
+    setupDebugMessenger();
+    if (!config.headless)
+        createSurface();
+
+    pickPhysicalDevice();
+    createLogicalDevice();
+    createMemoryAllocator();
+
+    if (config.headless)
+    {
+        createOffscreenImages();
+    }
+    else
+    {
+        createSwapChain();
+    }
+
+    createImageViews();
+    createRenderPass();
+    createShaderLibrary();
+    createPipelineCache();
+    createDescriptorResources();
+    createGraphicsPipeline();
+    createFramebuffers();
+    createCommandPool();
+    createUploader();
+    createVertexBuffer();
+    createIndexBuffer();
+    createInstanceBuffer();
+    createCuller();
+    createParticleSimulation();
+    if (config.drawMode == DrawMode::Indirect && !culler)
+        createIndirectBuffer();
+    createFrameUniformBuffers();
+
+    // No need to wait, graphics queue acquires uploaded buffers before first frame is submitted
+    uploader->submit();
+
+    createCommandBuffers();
+    createGpuProfiler();
+    createSyncObjects();
+
+    std::cout << "Device capabilities queried " << deviceCapabilities.getQueryCount() << " times, reused "
+              << deviceCapabilities.getHitCount() << " times" << std::endl;
+    std::cout << "Drawing " << instances.size() << " instances " << drawModeName(config.drawMode) << ", "
+              << getObjectDrawCallCount() << " draw calls per draw" << std::endl;
+    if (particles)
+        std::cout << "Simulating " << instances.size() << " particles on "
+                  << (computeQueue != graphicsQueue ? "async compute queue of family " +
+                                                      std::to_string(computeFamily)
+                                                    : std::string("graphics queue")) << std::endl;
+    if (culler)
+        std::cout << "GPU culling enabled, " << (culler->usesDrawIndirectCount() ? "compacted" : "zeroed")
+                  << " draws of culled objects" << std::endl;
+    std::cout << "Descriptors: " << descriptorLayoutCache->getLayoutCount() << " set layouts, "
+              << (useBindless ? "bindless table" : "per-frame pools") << std::endl;
+}
+
+void HelloTriangleApplication::mainLoop()
+{
+    uint64_t frameCount = 0;
+    recordingTime = 0.0;
+    runStats.frameTimes.reserve(config.frameLimit);
+    auto startTime = std::chrono::steady_clock::now();
+
+    while (config.headless || !glfwWindowShouldClose(window))
+    {
+        auto frameStartTime = std::chrono::steady_clock::now();
+
+        {
+            CpuZone zone("frame");
+
+            drawFrame();
+
+            CpuZone uploadsZone("collect uploads");
+            uploader->collectFinished();
+        }
+
+        std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStartTime;
+        runStats.frameTimes.push_back(frameTime.count());
+
+        if (swapChainRecreated)
+        {
+            std::chrono::duration<double, std::milli> runTime =
+                    std::chrono::steady_clock::now() - startTime;
+
+            std::cout << "Resized swap chain to " << swapChainExtent.width << "x" << swapChainExtent.height
+                      << ": recreation " << lastRecreationTime << " ms, hitch frame " << frameTime.count()
+                      << " ms (average " << runTime.count() / (frameCount + 1) << " ms)" << std::endl;
+
+            swapChainRecreated = false;
+        }
+
+        frameCount++;
+        if (config.frameLimit != 0 && frameCount >= config.frameLimit)
+            break;
+    }
+
+    vkDeviceWaitIdle(device);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    runStats.mainLoopTime = elapsed.count() * 1000.0;
+
+    if (frameCount > 0 && elapsed.count() > 0.0)
+        std::cout << "Rendered " << frameCount << " frames with " << config.framesInFlight
+                  << " in flight: " << elapsed.count() * 1000.0 / frameCount << " ms/frame, "
+                  << frameCount / elapsed.count() << " fps" << std::endl;
+
+    if (frameCount > 0)
+        std::cout << "Recorded " << config.drawCount << " draws per frame "
+                  << (commandRecorder ? "on " + std::to_string(commandRecorder->getMaxPartitions()) + " threads"
+                                      : std::string("inline"))
+                  << ": " << recordingTime * 1000.0 / frameCount << " ms/frame" << std::endl;
+
+    printLatencyStats();
+
+    if (gpuProfiler)
+    {
+        gpuProfiler->resolveAll();
+        gpuProfiler->printSummary(std::cout);
+        gpuProfiler->exportToFile(config.gpuProfilePath);
+    }
+
+    // Separate timeline, timestamps of different queues can't be compared
+    if (computeProfiler)
+    {
+        computeProfiler->resolveAll();
+        std::cout << "Compute queue:" << std::endl;
+        computeProfiler->printSummary(std::cout);
+        computeProfiler->exportToFile(getComputeProfilePath());
+    }
+}
+
+std::string HelloTriangleApplication::getComputeProfilePath() const
+{
+    const std::string &path = config.gpuProfilePath;
+
+    size_t extension = path.find_last_of('.');
+    size_t directory = path.find_last_of("/\\");
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+        return path + ".compute";
+
+    return path.substr(0, extension) + ".compute" + path.substr(extension);
+}
+
+void HelloTriangleApplication::printLatencyStats()
+{
+    if (inputToPresentLatencies.empty())
+        return;
+
+    TimingStats stats = computeTimingStats(inputToPresentLatencies);
+
+    std::cout << "Input to present latency (" << presentPolicyName(config.presentPolicy) << "): average "
+              << stats.average << " ms, p50 " << stats.p50 << " ms, p99 " << stats.p99
+              << " ms, max " << stats.max << " ms" << std::endl;
+}
+
+void HelloTriangleApplication::runRecordingBenchmark()
+{
+    const uint32_t drawCounts[] = {1000, 10000, 100000};
+    const uint32_t iterations = 20;
+
+    std::vector<uint32_t> threadCounts = {0};
+    for (uint32_t threads = 1; threads <= threadPool->getThreadCount() + 1; threads *= 2)
+        threadCounts.push_back(threads);
+
+    VkCommandBuffer commandBuffer = commandBuffers[0];
+    currentFrame = 0;
+    updateFrameDescriptors();
+
+    // Nothing is submitted, so timestamps would never be written
+    gpuProfiler.reset();
+
+    std::cout << "draws\tthreads\tms\tspeedup" << std::endl;
+
+    for (uint32_t drawCount : drawCounts)
+    {
+        double inlineTime = 0.0;
+
+        for (uint32_t threads : threadCounts)
+        {
+            std::unique_ptr<ParallelCommandRecorder> recorder;
+            if (threads > 0)
+                recorder = std::make_unique<ParallelCommandRecorder>(
+                        device, findQueueFamilies(physicalDevice).graphicsFamily.value(), *threadPool, 1,
+                        threads, allocationCallbacks);
+
+            auto startTime = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                vkResetCommandBuffer(commandBuffer, 0);
+                recordCommandBuffer(commandBuffer, 0, drawCount, recorder.get());
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+            double time = elapsed.count() / iterations;
+            if (threads == 0)
+                inlineTime = time;
+
+            std::cout << drawCount << "\t" << (threads == 0 ? "inline" : std::to_string(threads)) << "\t"
+                      << time << "\t" << inlineTime / time << std::endl;
+        }
+    }
+
+    vkResetCommandBuffer(commandBuffer, 0);
+}
+
+void HelloTriangleApplication::cleanup()
+{
+    CpuZone zone("cleanup");
+
+    for (size_t i = 0; i < config.framesInFlight; i++)
+    {
+        vkDestroySemaphore(device, imageAvailableSemaphores[i], allocationCallbacks);
+        vkDestroyFence(device, inFlightFences[i], allocationCallbacks);
+    }
+
+    for (auto semaphore : renderFinishedSemaphores)
+        vkDestroySemaphore(device, semaphore, allocationCallbacks);
+
+    uploader.reset();
+
+    memoryAllocator->destroyBuffer(indexBuffer, indexBufferMemory);
+    memoryAllocator->destroyBuffer(vertexBuffer, vertexBufferMemory);
+    memoryAllocator->destroyBuffer(instanceBuffer, instanceBufferMemory);
+
+    if (indirectBuffer != VK_NULL_HANDLE)
+        memoryAllocator->destroyBuffer(indirectBuffer, indirectBufferMemory);
+
+    culler.reset();
+    particles.reset();
+
+    for (size_t i = 0; i < frameUniformBuffers.size(); i++)
+        memoryAllocator->destroyBuffer(frameUniformBuffers[i], frameUniformMemory[i]);
+
+    gpuProfiler.reset();
+    computeProfiler.reset();
+    commandRecorder.reset();
+    vkDestroyCommandPool(device, commandPool, allocationCallbacks);
+
+    for (auto framebuffer : swapChainFramebuffers)
+        vkDestroyFramebuffer(device, framebuffer, allocationCallbacks);
+
+    for (auto pipeline : pipelineVariants)
+        vkDestroyPipeline(device, pipeline, allocationCallbacks);
+
+    // Owns graphicsPipeline as well
+    pipelineRegistry.reset();
+
+    if (!config.pipelineCachePath.empty())
+        savePipelineCacheData(config.pipelineCachePath, device, pipelineCache);
+    vkDestroyPipelineCache(device, pipelineCache, allocationCallbacks);
+
+    vkDestroyPipelineLayout(device, pipelineLayout, allocationCallbacks);
+
+    bindlessTable.reset();
+    frameDescriptorAllocator.reset();
+    descriptorLayoutCache.reset();
+    vkDestroyRenderPass(device, renderPass, allocationCallbacks);
+
+    pipelineBuilder.reset();
+    shaderLibrary.reset();
+
+    for (auto imageView : swapChainImageViews)
+        vkDestroyImageView(device, imageView, allocationCallbacks);
+
+    if (config.headless)
+    {
+        // Offscreen images are owned by us, not by a swap chain
+        for (size_t i = 0; i < swapChainImages.size(); i++)
+            memoryAllocator->destroyImage(swapChainImages[i], offscreenImagesMemory[i]);
+    }
+    else
+    {
+        vkDestroySwapchainKHR(device, swapChain, allocationCallbacks);
+    }
+
+    // Device is idle at this point, nothing uses them anymore
+    for (auto &retired : retiredSwapChains)
+        destroyRetiredSwapChain(retired);
+    retiredSwapChains.clear();
+
+    memoryAllocator->printStats(std::cout);
+    memoryAllocator.reset();
+
+    vkDestroyDevice(device, allocationCallbacks);
+
+    if (enableValidationLayers)
+        DestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocationCallbacks);
+
+    if (!config.headless)
+    {
+        vkDestroySurfaceKHR(instance, surface, allocationCallbacks);
+        deviceCapabilities.invalidateSurface();
+    }
+
+    vkDestroyInstance(instance, allocationCallbacks);
+
+    if (allocationCallbacks != nullptr)
+        hostAllocator.printStats(std::cout);
+
+    if (!config.headless)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    threadPool.reset();
+}
+
+void HelloTriangleApplication::createInstance()
+{
+    CpuZone zone("createInstance");
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VkStructureType::VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Hello Vulkan";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    // 1.1 for vkGetPhysicalDeviceProperties2, which reports device UUID
+    appInfo.apiVersion = VK_API_VERSION_1_1;
+
+
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VkStructureType::VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+
+    // printAvailableExtensions();
+    auto extensions = getRequiredExtensions();
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
+
+
+    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo; // using outer scope for disabling self-destruct
+    if (enableValidationLayers)
+    {
+        if (!checkValidationLayerSupport())
+            throw std::runtime_error("Validation layers requested, but not available!");
+
+        createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+        createInfo.ppEnabledLayerNames = validationLayers.data();
+
+        debugCreateInfo = createDebugMessengerCreateInfo();
+        createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT *) &debugCreateInfo;
+    }
+    else
+    {
+        createInfo.enabledLayerCount = 0;
+    }
+
+    VkResult result = vkCreateInstance(&createInfo, allocationCallbacks, &instance);
+
+    if (result != VkResult::VK_SUCCESS)
+        throw std::runtime_error("Failed to create Vulkan instance!");
+
+}
+
+void HelloTriangleApplication::printAvailableExtensions()
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+
+    std::cout << "available extensions:" << std::endl;
+    for (const auto &extension : extensions)
+        std::cout << "\t" << extension.extensionName << std::endl;
+}
+
+bool HelloTriangleApplication::checkValidationLayerSupport()
+{
+    uint32_t layerCount;
+    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+
+    std::vector<VkLayerProperties> availableLayers(layerCount);
+    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+
+    for (const char *requiredLayerName : validationLayers)
+    {
+        bool layerFound = false;
+
+        for (const auto &availableLayerProperties : availableLayers)
+            if (strcmp(requiredLayerName, availableLayerProperties.layerName) == 0) \
+
+            {
+                layerFound = true;
+                break;
+            }
+
+
+        if (!layerFound)
+            return false;
+    }
+    return true;
+}
+
+std::vector<const char *> HelloTriangleApplication::getRequiredExtensions()
+{
+    std::vector<const char *> extensions;
+
+    // Headless mode never touches GLFW, so there is no surface and no surface extensions
+    if (!config.headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+
+    if (enableValidationLayers)
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+
+
+    return extensions;
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL HelloTriangleApplication::debugCallback(
+        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+        VkDebugUtilsMessageTypeFlagsEXT messageType,
+        const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
+        void *pUserData
+)
+{
+
+    if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+        std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
+    else
+        std::cout << "validation layer: " << pCallbackData->pMessage << std::endl;
+
+    return VK_FALSE;
+}
+
+void HelloTriangleApplication::setupDebugMessenger()
+{
+    CpuZone zone("setupDebugMessenger");
+
+    if (!enableValidationLayers)
+        return;
+
+    VkDebugUtilsMessengerCreateInfoEXT createInfo = createDebugMessengerCreateInfo();
+
+
+    VkResult result = CreateDebugUtilsMessengerEXT(instance, &createInfo, allocationCallbacks, &debugMessenger);
+    if (result != VkResult::VK_SUCCESS)
+        throw std::runtime_error("Failed to set up debug messenger!");
+}
+
+VkDebugUtilsMessengerCreateInfoEXT HelloTriangleApplication::createDebugMessengerCreateInfo()
+{
+    VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    createInfo.messageSeverity =
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    createInfo.messageType =
+            VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+    createInfo.pfnUserCallback = debugCallback;
+    createInfo.pUserData = nullptr;
+
+    return createInfo;
+}
+
+void HelloTriangleApplication::createSurface()
+{
+    CpuZone zone("createSurface");
+
+    VkResult result = glfwCreateWindowSurface(instance, window, allocationCallbacks, &surface);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create window surface!");
+}
+
+void HelloTriangleApplication::pickPhysicalDevice()
+{
+    CpuZone zone("pickPhysicalDevice");
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+    if (deviceCount == 0)
+        throw std::runtime_error("failed to find GPUs with Vulkan support!");
+
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    uint64_t bestScore = 0;
+
+    for (const auto &device : devices)
+    {
+        const DeviceCapabilities &capabilities = getCapabilities(device);
+        const VkPhysicalDeviceProperties &deviceProperties = capabilities.properties;
+        const uint8_t *uuid = capabilities.hasUuid ? capabilities.uuid : nullptr;
+
+        bool suitable = isDeviceSuitable(device);
+        uint64_t score = suitable ? rateDevice(device) : 0;
+
+        std::cout << "Found GPU: " << deviceProperties.deviceName << " ("
+                  << deviceTypeName(deviceProperties.deviceType)
+                  << (uuid != nullptr ? ", " + formatUuid(uuid) : std::string()) << "), ";
+        if (suitable)
+            std::cout << "score " << score << std::endl;
+        else
+            std::cout << "not suitable" << std::endl;
+
+        if (!config.gpuSelector.empty())
+        {
+            // Override wins over any score, first match is taken
+            if (physicalDevice != VK_NULL_HANDLE ||
+                !matchesDeviceSelector(config.gpuSelector, deviceProperties.deviceName, uuid))
+                continue;
+
+            if (!suitable)
+                throw std::runtime_error(std::string("GPU ") + deviceProperties.deviceName +
+                                         " selected by --gpu is not suitable!");
+
+            physicalDevice = device;
+        }
+        else if (suitable && (physicalDevice == VK_NULL_HANDLE || score > bestScore))
+        {
+            physicalDevice = device;
+            bestScore = score;
+        }
+    }
+
+    if (physicalDevice == VK_NULL_HANDLE && !config.gpuSelector.empty())
+        throw std::runtime_error("no GPU matches --gpu " + config.gpuSelector + "!");
+
+    if (physicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("failed to find a suitable GPU!");
+
+    std::cout << "Selected GPU: " << getCapabilities(physicalDevice).properties.deviceName << std::endl;
+}
+
+const DeviceCapabilities &HelloTriangleApplication::getCapabilities(VkPhysicalDevice device)
+{
+    return deviceCapabilities.get(device, surface);
+}
+
+bool HelloTriangleApplication::isDeviceSuitable(VkPhysicalDevice device)
+{
+    // Extension support is needed in execution down below (swap chain suppor precisely), so first of all checking it
+    bool extensionsSupported = checkDeviceExtensionSupport(device);
+    if (!extensionsSupported)
+        return false;
+
+    QueueFamilyIndices indices = findQueueFamilies(device);
+
+    // Render nodes and CI machines often have nothing but a software rasterizer like lavapipe
+    if (config.headless)
+        return indices.isComplete();
+
+    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+    bool swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+
+    return indices.isComplete() && swapChainAdequate;
+}
+
+uint64_t HelloTriangleApplication::rateDevice(VkPhysicalDevice device)
+{
+    const DeviceCapabilities &capabilities = getCapabilities(device);
+    const VkPhysicalDeviceProperties &deviceProperties = capabilities.properties;
+    const VkPhysicalDeviceFeatures &deviceFeatures = capabilities.features;
+    const VkPhysicalDeviceMemoryProperties &memoryProperties = capabilities.memoryProperties;
+
+    uint64_t score = 0;
+
+    switch (deviceProperties.deviceType)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            score += 1000000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            score += 100000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            score += 10000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            score += 1000;
+            break;
+        default:
+            break;
+    }
+
+    // Device local memory in 16 MiB units, capped below the gap between device types
+    VkDeviceSize deviceLocalMemory = 0;
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            deviceLocalMemory += memoryProperties.memoryHeaps[i].size;
+    score += std::min<uint64_t>(deviceLocalMemory / (16 * 1024 * 1024), 8000);
+
+    score += deviceProperties.limits.maxImageDimension2D / 1024;
+
+    // One family for both means no ownership transfers or concurrent sharing of swap chain images
+    QueueFamilyIndices indices = findQueueFamilies(device);
+    if (indices.presentRequired && indices.graphicsFamily == indices.presentFamily)
+        score += 50;
+
+    if (deviceFeatures.multiDrawIndirect)
+        score += 10;
+    if (deviceFeatures.samplerAnisotropy)
+        score += 10;
+
+    return score;
+}
+
+std::vector<const char *> HelloTriangleApplication::getRequiredDeviceExtensions()
+{
+    if (config.headless)
+        return {};
+
+    return deviceExtensions;
+}
+
+bool HelloTriangleApplication::checkDeviceExtensionSupport(VkPhysicalDevice device)
+{
+    const DeviceCapabilities &capabilities = getCapabilities(device);
+
+    for (const char *extension : getRequiredDeviceExtensions())
+        if (!capabilities.supportsExtension(extension))
+            return false;
+
+    return true;
+}
+
+HelloTriangleApplication::QueueFamilyIndices HelloTriangleApplication::findQueueFamilies(VkPhysicalDevice device)
+{
+    QueueFamilyIndices indices;
+    indices.presentRequired = surface != VK_NULL_HANDLE;
+
+    const DeviceCapabilities &capabilities = getCapabilities(device);
+    const auto &queueFamilies = capabilities.queueFamilies;
+
+    // Transfer-only family usually maps to copy engines running independently of graphics,
+    // compute family without graphics is the next best thing
+    std::optional<uint32_t> computeFamily;
+
+    uint32_t i = 0;
+    for (const auto &queueFamily : queueFamilies)
+    {
+        VkQueueFlags flags = queueFamily.queueFlags;
+
+        if ((flags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily.has_value())
+            indices.graphicsFamily = i;
+
+        if (indices.presentRequired && !indices.presentFamily.has_value() && capabilities.presentSupport[i])
+            indices.presentFamily = i;
+
+        // Compute families can always transfer, whether they report it or not
+        if (!(flags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            if (!(flags & VK_QUEUE_COMPUTE_BIT) && (flags & VK_QUEUE_TRANSFER_BIT) &&
+                !indices.transferFamily.has_value())
+                indices.transferFamily = i;
+
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && !computeFamily.has_value())
+                computeFamily = i;
+        }
+
+        i++;
+    }
+
+    if (!indices.transferFamily.has_value())
+        indices.transferFamily = computeFamily;
+
+    if (config.asyncCompute)
+        indices.computeFamily = computeFamily;
+
+    return indices;
+}
+
+void HelloTriangleApplication::createLogicalDevice()
+{
+    CpuZone zone("createLogicalDevice");
+
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+
+
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    std::set<uint32_t> uniqueQueueFamilies = indices.getUniqueQueues();
+
+    // Without transfer-only family uploads go to compute family as well. Compute gets a queue of its own
+    // then if family has more than one, otherwise both share it.
+    const auto &queueFamilies = getCapabilities(physicalDevice).queueFamilies;
+    uint32_t computeQueueIndex = 0;
+    if (indices.computeFamily.has_value() && indices.computeFamily == indices.transferFamily &&
+        queueFamilies[indices.computeFamily.value()].queueCount > 1)
+        computeQueueIndex = 1;
+
+    float queuePriorities[] = {1.0f, 1.0f};
+    for (uint32_t queueFamily : uniqueQueueFamilies)
+    {
+        VkDeviceQueueCreateInfo queueCreateInfo{};
+        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex = queueFamily;
+        queueCreateInfo.queueCount = queueFamily == indices.computeFamily ? computeQueueIndex + 1 : 1;
+        queueCreateInfo.pQueuePriorities = queuePriorities;
+        queueCreateInfos.push_back(queueCreateInfo);
+    }
+
+    // Indirect draw mode batches better with these, but copes without them
+    const VkPhysicalDeviceFeatures &supportedFeatures = getCapabilities(physicalDevice).features;
+
+    VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+    auto extensions = getRequiredDeviceExtensions();
+
+    // Lets culled draws disappear from indirect buffer instead of being drawn with zero instances
+    const DeviceCapabilities &capabilities = getCapabilities(physicalDevice);
+    drawIndirectCountEnabled = config.gpuCulling && supportedFeatures.multiDrawIndirect &&
+                               capabilities.supportsExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (drawIndirectCountEnabled)
+        extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    if (config.bindless)
+    {
+        useBindless = BindlessDescriptorTable::isSupported(capabilities);
+
+        if (useBindless)
+        {
+            BindlessDescriptorTable::enableFeatures(deviceFeatures, descriptorIndexingFeatures);
+            extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        }
+        else
+        {
+            std::cout << "Descriptor indexing is not supported, using per-frame descriptor sets" << std::endl;
+        }
+    }
+
+    VkDeviceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = useBindless ? &descriptorIndexingFeatures : nullptr;
+    createInfo.pQueueCreateInfos = queueCreateInfos.data();
+    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());;
+
+    createInfo.pEnabledFeatures = &deviceFeatures;
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
+
+    // Ignored by up-to-date implementations, but saved in case of outdated devices
+    if (enableValidationLayers)
+    {
+        createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+        createInfo.ppEnabledLayerNames = validationLayers.data();
+    }
+    else
+    {
+        createInfo.enabledLayerCount = 0;
+    }
+
+    VkResult result = vkCreateDevice(physicalDevice, &createInfo, allocationCallbacks, &device);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create logical device!");
+
+    vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
+    if (indices.presentFamily.has_value())
+        vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+
+    transferFamily = indices.transferFamily.value_or(indices.graphicsFamily.value());
+    vkGetDeviceQueue(device, transferFamily, 0, &transferQueue);
+
+    computeFamily = indices.computeFamily.value_or(indices.graphicsFamily.value());
+    vkGetDeviceQueue(device, computeFamily, computeQueueIndex, &computeQueue);
+}
+
+HelloTriangleApplication::SwapChainSupportDetails
+HelloTriangleApplication::querySwapChainSupport(VkPhysicalDevice device)
+{
+    SwapChainSupportDetails details;
+
+    // Current extent follows window size, so only this one is queried every time
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
+
+    const DeviceCapabilities &capabilities = getCapabilities(device);
+    details.formats = capabilities.surfaceFormats;
+    details.presentModes = capabilities.presentModes;
+
+    return details;
+}
+
+VkSurfaceFormatKHR
+HelloTriangleApplication::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats)
+{
+    for (const auto &availableFormat : availableFormats)
+        if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB &&
+            availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+            return availableFormat;
+
+    return availableFormats[0];
+}
+
+VkPresentModeKHR
+HelloTriangleApplication::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes)
+{
+    std::vector<VkPresentModeKHR> preferredModes;
+    switch (config.presentPolicy)
+    {
+        case PresentPolicy::LowLatency:
+            preferredModes = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+        case PresentPolicy::Throughput:
+            preferredModes = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+            break;
+        case PresentPolicy::PowerSaving:
+            preferredModes = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+            break;
+    }
+
+    for (auto preferredMode : preferredModes)
+        if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferredMode) !=
+            availablePresentModes.end())
+            return preferredMode;
+
+    // The only one guaranteed to be available
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t HelloTriangleApplication::chooseSwapImageCount(const VkSurfaceCapabilitiesKHR &capabilities)
+{
+    // Every extra image is one more frame of queueing between GPU and display
+    uint32_t imageCount = capabilities.minImageCount;
+    switch (config.presentPolicy)
+    {
+        case PresentPolicy::LowLatency:
+            break;
+        case PresentPolicy::Throughput:
+            // Second spare image lets three frames in flight each have a target without waiting for display
+            imageCount += 2;
+            break;
+        case PresentPolicy::PowerSaving:
+            imageCount++;
+            break;
+    }
+
+    // MAILBOX needs an image to render into while one is displayed and another one is queued
+    imageCount = std::max(imageCount, 2u);
+
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+        imageCount = capabilities.maxImageCount;
+
+    return imageCount;
+}
+
+const char *HelloTriangleApplication::presentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            return "IMMEDIATE";
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            return "MAILBOX";
+        case VK_PRESENT_MODE_FIFO_KHR:
+            return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+            return "FIFO_RELAXED";
+        default:
+            return "unknown";
+    }
+}
+
+VkExtent2D HelloTriangleApplication::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities)
+{
+    if (capabilities.currentExtent.width != UINT32_MAX)
+        return capabilities.currentExtent;
+
+    VkExtent2D actualExtent = {WIDTH, HEIGHT};
+
+    if (window != nullptr)
+    {
+        // Window could be resized, and on high DPI screens pixels differ from screen coordinates anyway
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+
+        actualExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    }
+
+    actualExtent.width = std::max(capabilities.minImageExtent.width,
+                                  std::min(capabilities.maxImageExtent.width, actualExtent.width));
+    actualExtent.height = std::max(capabilities.minImageExtent.height,
+                                   std::min(capabilities.maxImageExtent.height, actualExtent.height));
+
+    return actualExtent;
+}
+
+void HelloTriangleApplication::createSwapChain(VkSwapchainKHR oldSwapChain)
+{
+    CpuZone zone("createSwapChain");
+
+    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
+
+    VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
+    VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
+
+    uint32_t imageCount = chooseSwapImageCount(swapChainSupport.capabilities);
+
+    VkSwapchainCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+
+    if (indices.graphicsFamily != indices.presentFamily)
+    {
+        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        createInfo.queueFamilyIndexCount = 2;
+        createInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
+    else
+    {
+        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        createInfo.queueFamilyIndexCount = 0;
+        createInfo.pQueueFamilyIndices = nullptr;
+    }
+
+    createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = presentMode;
+    createInfo.clipped = VK_TRUE;
+
+    // Lets implementation reuse resources and keep presenting already acquired images of old one
+    createInfo.oldSwapchain = oldSwapChain;
+
+
+    VkResult result = vkCreateSwapchainKHR(device, &createInfo, allocationCallbacks, &swapChain);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create swap chain!");
+
+    vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr);
+    swapChainImages.resize(imageCount);
+    vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages.data());
+
+    swapChainImageFormat = surfaceFormat.format;
+    swapChainExtent = extent;
+
+    if (oldSwapChain == VK_NULL_HANDLE)
+        std::cout << "Presenting with " << presentModeName(presentMode) << ", " << imageCount << " images, "
+                  << config.framesInFlight << " frames in flight (" << presentPolicyName(config.presentPolicy)
+                  << " policy)" << std::endl;
+}
+
+void HelloTriangleApplication::createMemoryAllocator()
+{
+    CpuZone zone("createMemoryAllocator");
+
+    memoryAllocator = std::make_unique<DeviceMemoryAllocator>(getCapabilities(physicalDevice), device,
+                                                              DeviceMemoryAllocator::DEFAULT_BLOCK_SIZE,
+                                                              allocationCallbacks);
+}
+
+void HelloTriangleApplication::createOffscreenImages()
+{
+    CpuZone zone("createOffscreenImages");
+
+    // Any renderable format works here, nobody is going to display it
+    swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    swapChainExtent = {WIDTH, HEIGHT};
+
+    // One target per frame in flight, so frames never wait on each other's attachment
+    swapChainImages.resize(config.framesInFlight);
+    offscreenImagesMemory.resize(config.framesInFlight);
+
+    for (size_t i = 0; i < swapChainImages.size(); i++)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = swapChainImageFormat;
+        imageInfo.extent = {swapChainExtent.width, swapChainExtent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        swapChainImages[i] = memoryAllocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                          offscreenImagesMemory[i]);
+    }
+}
+
+void HelloTriangleApplication::createImageViews()
+{
+    CpuZone zone("createImageViews");
+
+    swapChainImageViews.resize(swapChainImages.size());
+
+    for (size_t i = 0; i < swapChainImages.size(); i++)
+    {
+        VkImageViewCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        createInfo.image = swapChainImages[i];
+        createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        createInfo.format = swapChainImageFormat;
+
+        createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+        createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        createInfo.subresourceRange.baseMipLevel = 0;
+        createInfo.subresourceRange.levelCount = 1;
+        createInfo.subresourceRange.baseArrayLayer = 0;
+        createInfo.subresourceRange.layerCount = 1;
+
+        VkResult result = vkCreateImageView(device, &createInfo, allocationCallbacks, &swapChainImageViews[i]);
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("failed to create image views!");
+    }
+}
+
+void HelloTriangleApplication::createGraphicsPipeline()
+{
+    CpuZone zone("createGraphicsPipeline");
+
+    VkDescriptorSetLayout setLayout = useBindless ? bindlessTable->getLayout() : frameSetLayout;
+
+    // Bindless shaders find their frame data through index pushed once per command buffer
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = useBindless ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = useBindless ? &pushConstantRange : nullptr;
+
+    VkResult result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocationCallbacks, &pipelineLayout);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline layout!");
+
+
+    pipelineBuilder = std::make_unique<PipelineBuilder>(device, *shaderLibrary, pipelineCache, *threadPool,
+                                                        allocationCallbacks);
+    pipelineRegistry = std::make_unique<PipelineRegistry>(device, *shaderLibrary, *pipelineBuilder);
+
+    GraphicsPipelineDescription description;
+    description.vertexShader = useBindless ? "vert_bindless.spv" : "vert.spv";
+    description.fragmentShader = "frag.spv";
+    description.vertexBindings = Vertex::getBindingDescriptions();
+    description.vertexBindings.push_back(Instance::getBindingDescription());
+    description.vertexAttributes = Vertex::getAttributeDescriptions();
+    for (const auto &attribute : Instance::getAttributeDescriptions())
+        description.vertexAttributes.push_back(attribute);
+    description.layout = pipelineLayout;
+    description.renderPass = renderPass;
+
+
+    auto pipelineStartTime = std::chrono::steady_clock::now();
+
+    // Only what the first frame needs, everything else is compiled by registry on first use
+    pipelineRegistry->prewarm({description});
+    graphicsPipeline = pipelineRegistry->get(description);
+
+    std::chrono::duration<double, std::milli> pipelineTime = std::chrono::steady_clock::now() - pipelineStartTime;
+    std::cout << "Compiled " << pipelineRegistry->getPipelineCount() << " graphics pipelines on "
+              << threadPool->getThreadCount() << " threads in " << pipelineTime.count() << " ms ("
+              << (pipelineCacheWarm ? "warm" : "cold") << " pipeline cache)" << std::endl;
+
+    if (config.pipelineCount > 1)
+    {
+        // Registry would deduplicate identical states, and pipeline cache would turn them into cache hits
+        PipelineBuilder uncachedBuilder(device, *shaderLibrary, VK_NULL_HANDLE, *threadPool,
+                                        allocationCallbacks);
+
+        auto variantsStartTime = std::chrono::steady_clock::now();
+
+        pipelineVariants = uncachedBuilder.buildBatch(
+                std::vector<GraphicsPipelineDescription>(config.pipelineCount - 1, description));
+
+        std::chrono::duration<double, std::milli> variantsTime =
+                std::chrono::steady_clock::now() - variantsStartTime;
+        std::cout << "Compiled " << pipelineVariants.size() << " pipeline variants without cache in "
+                  << variantsTime.count() << " ms" << std::endl;
+    }
+}
+
+void HelloTriangleApplication::createPipelineCache()
+{
+    CpuZone zone("createPipelineCache");
+
+    std::vector<char> initialData;
+
+    if (!config.pipelineCachePath.empty())
+    {
+        initialData = loadPipelineCacheData(config.pipelineCachePath,
+                                            getCapabilities(physicalDevice).properties);
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    VkResult result = vkCreatePipelineCache(device, &createInfo, allocationCallbacks, &pipelineCache);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline cache!");
+
+    pipelineCacheWarm = !initialData.empty();
+}
+
+void HelloTriangleApplication::createShaderLibrary()
+{
+    CpuZone zone("createShaderLibrary");
+
+    shaderLibrary = std::make_unique<ShaderLibrary>(device, allocationCallbacks);
+
+    // Override directory goes first, so its files win over embedded shaders of the same name
+    size_t fileCount = 0;
+    if (!config.shaderDirectory.empty())
+        fileCount = shaderLibrary->loadDirectory(config.shaderDirectory);
+
+    size_t embeddedCount = shaderLibrary->loadEmbedded();
+
+    // Build without glslc embeds nothing, files next to working directory are all there is then
+    if (getEmbeddedShaderCount() == 0 && config.shaderDirectory.empty())
+        fileCount = shaderLibrary->loadDirectory("shaders");
+
+    std::cout << "Loaded " << embeddedCount << " embedded shaders and " << fileCount << " shader files into "
+              << shaderLibrary->getModuleCount() << " shader modules" << std::endl;
+}
+
+void HelloTriangleApplication::createRenderPass()
+{
+    CpuZone zone("createRenderPass");
+
+    VkAttachmentDescription colorAttachment{};
+    colorAttachment.format = swapChainImageFormat;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Offscreen targets are left ready for readback instead of presentation
+    colorAttachment.finalLayout = config.headless ?
+                                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL :
+                                  VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorAttachmentRef{};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentRef;
+
+    // Image layout transition must wait until acquired image is actually released by presentation
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
+
+    VkResult result = vkCreateRenderPass(device, &renderPassInfo, allocationCallbacks, &renderPass);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create render pass!");
+
+}
+
+void HelloTriangleApplication::createFramebuffers()
+{
+    CpuZone zone("createFramebuffers");
+
+    swapChainFramebuffers.resize(swapChainImageViews.size());
+
+    for (size_t i = 0; i < swapChainImageViews.size(); i++)
+    {
+        VkImageView attachments[] = {swapChainImageViews[i]};
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = attachments;
+        framebufferInfo.width = swapChainExtent.width;
+        framebufferInfo.height = swapChainExtent.height;
+        framebufferInfo.layers = 1;
+
+        VkResult result = vkCreateFramebuffer(device, &framebufferInfo, allocationCallbacks,
+                                              &swapChainFramebuffers[i]);
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("failed to create framebuffer!");
+    }
+}
+
+void HelloTriangleApplication::createCommandPool()
+{
+    CpuZone zone("createCommandPool");
+
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+    // Command buffers are re-recorded every frame, so each one is reset individually
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    VkResult result = vkCreateCommandPool(device, &poolInfo, allocationCallbacks, &commandPool);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create command pool!");
+}
+
+VkBuffer HelloTriangleApplication::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                                VkMemoryPropertyFlags properties, DeviceAllocation &bufferMemory)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    return memoryAllocator->createBuffer(bufferInfo, properties, bufferMemory);
+}
+
+void HelloTriangleApplication::createUploader()
+{
+    CpuZone zone("createUploader");
+
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+    uploader = std::make_unique<AsyncUploader>(device, *memoryAllocator, transferQueue, transferFamily,
+                                               graphicsQueue, queueFamilyIndices.graphicsFamily.value(),
+                                               allocationCallbacks);
+
+    if (uploader->usesDedicatedQueue())
+        std::cout << "Uploading through dedicated transfer queue family " << transferFamily << std::endl;
+}
+
+void HelloTriangleApplication::createDeviceLocalBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage,
+                                                       VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                                                       VkBuffer &buffer, DeviceAllocation &bufferMemory)
+{
+    buffer = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          bufferMemory);
+
+    uploader->enqueue(buffer, 0, data, size, dstStageMask, dstAccessMask);
+}
+
+void HelloTriangleApplication::generateGeometry()
+{
+    const Vertex triangle[] =
+            {
+                    {{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+                    {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+                    {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
+            };
+
+    uint32_t triangleCount = std::max(config.triangleCount, 1u);
+
+    // Square grid covering whole screen, each triangle shrunk into its own cell
+    auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(triangleCount))));
+    float cellSize = 2.0f / columns;
+    float scale = triangleCount == 1 ? 1.0f : cellSize;
+
+    vertices.clear();
+    indices.clear();
+    vertices.reserve(triangleCount * 3);
+    indices.reserve(triangleCount * 3);
+
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        float centerX = triangleCount == 1 ? 0.0f : -1.0f + cellSize * (i % columns + 0.5f);
+        float centerY = triangleCount == 1 ? 0.0f : -1.0f + cellSize * (i / columns + 0.5f);
+
+        for (const auto &corner : triangle)
+        {
+            Vertex vertex = corner;
+            vertex.position[0] = centerX + corner.position[0] * scale;
+            vertex.position[1] = centerY + corner.position[1] * scale;
+
+            indices.push_back(static_cast<uint32_t>(vertices.size()));
+            vertices.push_back(vertex);
+        }
+    }
+}
+
+void HelloTriangleApplication::generateInstances()
+{
+    uint32_t instanceCount = std::max(config.instanceCount, 1u);
+
+    // Same grid as generateGeometry(), single instance keeps the mesh as it is
+    auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+    float cellSize = 2.0f / columns;
+
+    instances.clear();
+    instances.reserve(instanceCount);
+
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        Instance instance{};
+        instance.scale = instanceCount == 1 ? 1.0f : cellSize;
+        instance.offset[0] = instanceCount == 1 ? 0.0f : -1.0f + cellSize * (i % columns + 0.5f);
+        instance.offset[1] = instanceCount == 1 ? 0.0f : -1.0f + cellSize * (i / columns + 0.5f);
+
+        // Shades vary across the grid, so neighbouring instances can be told apart
+        float u = instanceCount == 1 ? 1.0f : static_cast<float>(i % columns) / columns;
+        float v = instanceCount == 1 ? 1.0f : static_cast<float>(i / columns) / columns;
+        instance.color[0] = 0.5f + 0.5f * u;
+        instance.color[1] = 0.5f + 0.5f * v;
+        instance.color[2] = instanceCount == 1 ? 1.0f : 1.0f - 0.5f * u;
+
+        instances.push_back(instance);
+    }
+}
+
+void HelloTriangleApplication::createVertexBuffer()
+{
+    CpuZone zone("createVertexBuffer");
+
+    createDeviceLocalBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size(),
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                            vertexBuffer, vertexBufferMemory);
+}
+
+void HelloTriangleApplication::createIndexBuffer()
+{
+    CpuZone zone("createIndexBuffer");
+
+    createDeviceLocalBuffer(indices.data(), sizeof(indices[0]) * indices.size(),
+                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT,
+                            indexBuffer, indexBufferMemory);
+}
+
+void HelloTriangleApplication::createInstanceBuffer()
+{
+    CpuZone zone("createInstanceBuffer");
+
+    // Culling pass reads placements as objects' bounds
+    createDeviceLocalBuffer(instances.data(), sizeof(instances[0]) * instances.size(),
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+                            instanceBuffer, instanceBufferMemory);
+}
+
+void HelloTriangleApplication::createCuller()
+{
+    CpuZone zone("createCuller");
+
+    if (!config.gpuCulling)
+        return;
+
+    const DeviceCapabilities &capabilities = getCapabilities(physicalDevice);
+
+    if (!GpuCuller::isSupported(capabilities))
+    {
+        std::cout << "Indirect draws can't start at arbitrary instance, GPU culling is disabled" << std::endl;
+        return;
+    }
+
+    // Bounding sphere around mesh origin, instances only scale and move it
+    float meshRadius = 0.0f;
+    for (const auto &vertex : vertices)
+        meshRadius = std::max(meshRadius, std::hypot(vertex.position[0], vertex.position[1]));
+
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+    if (drawIndirectCountEnabled)
+        drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+
+    culler = std::make_unique<GpuCuller>(device, *memoryAllocator, *descriptorLayoutCache, *pipelineRegistry,
+                                         config.framesInFlight, static_cast<uint32_t>(instances.size()),
+                                         static_cast<uint32_t>(indices.size()), meshRadius,
+                                         drawIndexedIndirectCount, allocationCallbacks);
+
+    if (capabilities.features.multiDrawIndirect)
+        maxIndirectDrawsPerCall = std::max(1u, capabilities.properties.limits.maxDrawIndirectCount);
+    else
+        maxIndirectDrawsPerCall = 1;
+}
+
+void HelloTriangleApplication::createParticleSimulation()
+{
+    CpuZone zone("createParticleSimulation");
+
+    if (!config.particles)
+        return;
+
+    particles = std::make_unique<ParticleSimulation>(device, *memoryAllocator, *descriptorLayoutCache,
+                                                     *pipelineRegistry, computeQueue, computeFamily,
+                                                     findQueueFamilies(physicalDevice).graphicsFamily.value(),
+                                                     config.framesInFlight, instances, allocationCallbacks);
+}
+
+VkBuffer HelloTriangleApplication::getInstanceBuffer() const
+{
+    return particles ? particles->getCurrentBuffer() : instanceBuffer;
+}
+
+void HelloTriangleApplication::createIndirectBuffer()
+{
+    CpuZone zone("createIndirectBuffer");
+
+    const DeviceCapabilities &capabilities = getCapabilities(physicalDevice);
+
+    auto indexCount = static_cast<uint32_t>(indices.size());
+    auto instanceCount = static_cast<uint32_t>(instances.size());
+
+    std::vector<VkDrawIndexedIndirectCommand> commands;
+
+    // Non-zero firstInstance in indirect commands is an optional feature
+    if (capabilities.features.drawIndirectFirstInstance)
+    {
+        commands.resize(instanceCount);
+        for (uint32_t i = 0; i < instanceCount; i++)
+            commands[i] = {indexCount, 1, 0, 0, i};
+    }
+    else
+    {
+        commands.push_back({indexCount, instanceCount, 0, 0, 0});
+    }
+
+    indirectCommandCount = static_cast<uint32_t>(commands.size());
+
+    if (capabilities.features.multiDrawIndirect)
+        maxIndirectDrawsPerCall = std::max(1u, capabilities.properties.limits.maxDrawIndirectCount);
+    else
+        maxIndirectDrawsPerCall = 1;
+
+    createDeviceLocalBuffer(commands.data(), sizeof(commands[0]) * commands.size(),
+                            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                            indirectBuffer, indirectBufferMemory);
+}
+
+void HelloTriangleApplication::createCommandBuffers()
+{
+    CpuZone zone("createCommandBuffers");
+
+    commandBuffers.resize(config.framesInFlight);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+    VkResult result = vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate command buffers!");
+
+    if (config.recordThreads > 0)
+        commandRecorder = std::make_unique<ParallelCommandRecorder>(
+                device, findQueueFamilies(physicalDevice).graphicsFamily.value(), *threadPool,
+                config.framesInFlight, config.recordThreads, allocationCallbacks);
+}
+
+void HelloTriangleApplication::createGpuProfiler()
+{
+    CpuZone zone("createGpuProfiler");
+
+    if (config.gpuProfilePath.empty())
+        return;
+
+    gpuProfiler = std::make_unique<GpuProfiler>(getCapabilities(physicalDevice), device,
+                                                findQueueFamilies(physicalDevice).graphicsFamily.value(),
+                                                config.framesInFlight, 64, allocationCallbacks);
+
+    if (!gpuProfiler->isSupported())
+    {
+        std::cout << "Graphics queue doesn't support timestamps, GPU profiling is disabled" << std::endl;
+        gpuProfiler.reset();
+    }
+
+    if (!particles)
+        return;
+
+    computeProfiler = std::make_unique<GpuProfiler>(getCapabilities(physicalDevice), device, computeFamily,
+                                                    config.framesInFlight, 64, allocationCallbacks);
+
+    if (!computeProfiler->isSupported())
+    {
+        std::cout << "Compute queue doesn't support timestamps, it is not profiled" << std::endl;
+        computeProfiler.reset();
+    }
+}
+
+void HelloTriangleApplication::createDescriptorResources()
+{
+    CpuZone zone("createDescriptorResources");
+
+    descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(device, allocationCallbacks);
+
+    // Culling sets come from here even when frame uniforms are reached through bindless table
+    frameDescriptorAllocator = std::make_unique<FrameDescriptorAllocator>(
+            device, config.framesInFlight, FrameDescriptorAllocator::DEFAULT_SETS_PER_POOL,
+            allocationCallbacks);
+
+    if (useBindless)
+    {
+        bindlessTable = std::make_unique<BindlessDescriptorTable>(device, *descriptorLayoutCache,
+                                                                  BindlessDescriptorTable::DEFAULT_CAPACITY,
+                                                                  allocationCallbacks);
+        return;
+    }
+
+    VkDescriptorSetLayoutBinding uniformBinding{};
+    uniformBinding.binding = 0;
+    uniformBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uniformBinding.descriptorCount = 1;
+    uniformBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    frameSetLayout = descriptorLayoutCache->getLayout({uniformBinding});
+}
+
+void HelloTriangleApplication::createFrameUniformBuffers()
+{
+    CpuZone zone("createFrameUniformBuffers");
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(FrameUniforms);
+    // Bindless table holds storage buffers, culling pass reads the same data as uniform buffer
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    frameUniformBuffers.resize(config.framesInFlight);
+    frameUniformMemory.resize(config.framesInFlight);
+
+    for (size_t i = 0; i < config.framesInFlight; i++)
+    {
+        // Small and rewritten every frame, device local host visible memory is best when there is some
+        frameUniformBuffers[i] = memoryAllocator->createBuffer(bufferInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                                               frameUniformMemory[i],
+                                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Bindless slots are written once here and never touched again
+        if (useBindless)
+            frameUniformIndices.push_back(bindlessTable->addStorageBuffer(frameUniformBuffers[i]));
+    }
+}
+
+void HelloTriangleApplication::updateFrameDescriptors()
+{
+    std::chrono::duration<float> time = std::chrono::steady_clock::now() - runStartTime;
+
+    FrameUniforms uniforms{};
+    uniforms.tint[0] = uniforms.tint[1] = uniforms.tint[2] = uniforms.tint[3] = 1.0f;
+    uniforms.time = time.count();
+    updateCamera(uniforms, time.count());
+
+    DeviceAllocation &memory = frameUniformMemory[currentFrame];
+    memcpy(memory.mapped, &uniforms, sizeof(uniforms));
+    memoryAllocator->flush(memory);
+
+    // Frame's previous sets are done with, so all of them go away with one reset per pool
+    frameDescriptorAllocator->beginFrame(static_cast<uint32_t>(currentFrame));
+
+    if (culler)
+        culler->updateDescriptors(static_cast<uint32_t>(currentFrame), *frameDescriptorAllocator,
+                                  frameUniformBuffers[currentFrame], sizeof(FrameUniforms),
+                                  getInstanceBuffer());
+
+    if (useBindless)
+        return;
+
+    frameDescriptorSet = frameDescriptorAllocator->allocate(frameSetLayout);
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = frameUniformBuffers[currentFrame];
+    bufferInfo.offset = 0;
+    bufferInfo.range = sizeof(FrameUniforms);
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = frameDescriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void HelloTriangleApplication::updateCamera(FrameUniforms &uniforms, float time) const
+{
+    float zoom = static_cast<float>(std::max(config.zoom, 1u));
+    float halfExtent = 1.0f / zoom;
+
+    float centerX = (1.0f - halfExtent) * std::sin(time * 0.5f);
+    float centerY = (1.0f - halfExtent) * std::cos(time * 0.3f);
+
+    uniforms.view[0] = centerX;
+    uniforms.view[1] = centerY;
+    uniforms.view[2] = zoom;
+    uniforms.view[3] = zoom;
+
+    const float planes[4][4] =
+            {
+                    {1.0f, 0.0f, 0.0f, halfExtent - centerX},
+                    {-1.0f, 0.0f, 0.0f, halfExtent + centerX},
+                    {0.0f, 1.0f, 0.0f, halfExtent - centerY},
+                    {0.0f, -1.0f, 0.0f, halfExtent + centerY}
+            };
+    memcpy(uniforms.frustumPlanes, planes, sizeof(planes));
+}
+
+void HelloTriangleApplication::bindFrameDescriptors(VkCommandBuffer commandBuffer)
+{
+    if (useBindless)
+    {
+        VkDescriptorSet set = bindlessTable->getSet();
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &set,
+                                0, nullptr);
+
+        uint32_t frameIndex = frameUniformIndices[currentFrame];
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(frameIndex),
+                           &frameIndex);
+    }
+    else
+    {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                                &frameDescriptorSet, 0, nullptr);
+    }
+}
+
+void HelloTriangleApplication::recordDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t drawCount)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+
+    // All pipelines share one layout, so this stays bound while draws switch between them
+    bindFrameDescriptors(commandBuffer);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float) swapChainExtent.width;
+    viewport.height = (float) swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    VkBuffer vertexBuffers[] = {vertexBuffer, getInstanceBuffer()};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+    size_t pipelineCount = pipelineVariants.size() + 1;
+    size_t boundVariant = 0;
+
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+        // Each draw switches pipeline when there are variants to switch between
+        size_t variant = (first + i) % pipelineCount;
+        if (variant != boundVariant)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              variant == 0 ? graphicsPipeline : pipelineVariants[variant - 1]);
+            boundVariant = variant;
+        }
+
+        drawObjects(commandBuffer);
+    }
+}
+
+void HelloTriangleApplication::drawObjects(VkCommandBuffer commandBuffer)
+{
+    auto indexCount = static_cast<uint32_t>(indices.size());
+    auto instanceCount = static_cast<uint32_t>(instances.size());
+
+    switch (config.drawMode)
+    {
+        case DrawMode::PerObject:
+            for (uint32_t i = 0; i < instanceCount; i++)
+                vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, i);
+            break;
+
+        case DrawMode::Instanced:
+            vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, 0, 0, 0);
+            break;
+
+        case DrawMode::Indirect:
+            if (culler)
+            {
+                culler->recordDraws(commandBuffer, static_cast<uint32_t>(currentFrame),
+                                    maxIndirectDrawsPerCall);
+                break;
+            }
+
+            for (uint32_t first = 0; first < indirectCommandCount; first += maxIndirectDrawsPerCall)
+            {
+                uint32_t count = std::min(maxIndirectDrawsPerCall, indirectCommandCount - first);
+                vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer,
+                                         first * sizeof(VkDrawIndexedIndirectCommand), count,
+                                         sizeof(VkDrawIndexedIndirectCommand));
+            }
+            break;
+    }
+}
+
+uint32_t HelloTriangleApplication::getObjectDrawCallCount() const
+{
+    switch (config.drawMode)
+    {
+        case DrawMode::PerObject:
+            return static_cast<uint32_t>(instances.size());
+        case DrawMode::Instanced:
+            return 1;
+        case DrawMode::Indirect:
+            if (culler && culler->usesDrawIndirectCount())
+                return 1;
+            if (culler)
+                return (static_cast<uint32_t>(instances.size()) + maxIndirectDrawsPerCall - 1) /
+                       maxIndirectDrawsPerCall;
+            return (indirectCommandCount + maxIndirectDrawsPerCall - 1) / maxIndirectDrawsPerCall;
+    }
+
+    return 0;
+}
+
+void HelloTriangleApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex,
+                                                   uint32_t drawCount, ParallelCommandRecorder *recorder)
+{
+    CpuZone zone("record commands");
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording command buffer!");
+
+    // Profiler calls are no-ops without profiler
+    GpuProfiler *profiler = gpuProfiler.get();
+    uint32_t frameScope = UINT32_MAX, renderPassScope = UINT32_MAX, drawsScope = UINT32_MAX;
+
+    if (profiler != nullptr)
+    {
+        profiler->beginFrame(commandBuffer, static_cast<uint32_t>(currentFrame));
+        frameScope = profiler->beginScope(commandBuffer, "frame");
+    }
+
+    // Compute can't run inside render pass, draws wait for its output with a barrier
+    if (culler)
+    {
+        uint32_t cullingScope = UINT32_MAX;
+        if (profiler != nullptr)
+            cullingScope = profiler->beginScope(commandBuffer, "culling");
+
+        culler->recordCulling(commandBuffer, static_cast<uint32_t>(currentFrame));
+
+        if (profiler != nullptr)
+            profiler->endScope(commandBuffer, cullingScope);
+    }
+
+    if (profiler != nullptr)
+        renderPassScope = profiler->beginScope(commandBuffer, "render pass");
+
+    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = swapChainExtent;
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clearColor;
+
+    if (recorder != nullptr)
+    {
+        // Subpass with secondary contents allows nothing but vkCmdExecuteCommands, so timestamps of
+        // this scope wrap the whole render pass
+        if (profiler != nullptr)
+            drawsScope = profiler->beginScope(commandBuffer, "secondary draws");
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        recorder->record(static_cast<uint32_t>(currentFrame), commandBuffer, renderPass, 0,
+                         swapChainFramebuffers[imageIndex], drawCount,
+                         [this](VkCommandBuffer secondary, uint32_t first, uint32_t count)
+                         {
+                             recordDraws(secondary, first, count);
+                         });
+    }
+    else
+    {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        if (profiler != nullptr)
+            drawsScope = profiler->beginScope(commandBuffer, "draws");
+
+        recordDraws(commandBuffer, 0, drawCount);
+
+        if (profiler != nullptr)
+            profiler->endScope(commandBuffer, drawsScope);
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
+
+    if (profiler != nullptr)
+    {
+        if (recorder != nullptr)
+            profiler->endScope(commandBuffer, drawsScope);
+
+        profiler->endScope(commandBuffer, renderPassScope);
+        profiler->endScope(commandBuffer, frameScope);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record command buffer!");
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    recordingTime += elapsed.count();
+}
+
+void HelloTriangleApplication::createSyncObjects()
+{
+    CpuZone zone("createSyncObjects");
+
+    imageAvailableSemaphores.resize(config.framesInFlight);
+    inFlightFences.resize(config.framesInFlight);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Created signaled, so the very first wait on each frame doesn't block forever
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (size_t i = 0; i < config.framesInFlight; i++)
+    {
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks,
+                              &imageAvailableSemaphores[i]) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, allocationCallbacks, &inFlightFences[i]) != VK_SUCCESS)
+            throw std::runtime_error("failed to create synchronization objects for a frame!");
+    }
+
+    createSwapChainSyncObjects();
+}
+
+void HelloTriangleApplication::createSwapChainSyncObjects()
+{
+    renderFinishedSemaphores.resize(swapChainImages.size());
+    imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (auto &semaphore : renderFinishedSemaphores)
+    {
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create synchronization objects for a swap chain image!");
+    }
+}
+
+void HelloTriangleApplication::recreateSwapChain()
+{
+    CpuZone zone("recreateSwapChain");
+
+    // Minimized window has zero sized framebuffer, nothing to render into until it is restored
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    while (width == 0 || height == 0)
+    {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    RetiredSwapChain retired;
+    retired.swapChain = swapChain;
+    retired.imageViews = std::move(swapChainImageViews);
+    retired.framebuffers = std::move(swapChainFramebuffers);
+    retired.renderFinishedSemaphores = std::move(renderFinishedSemaphores);
+    retired.retiredAtFrame = submittedFrames;
+    retiredSwapChains.push_back(std::move(retired));
+
+    VkFormat oldFormat = swapChainImageFormat;
+
+    createSwapChain(retiredSwapChains.back().swapChain);
+
+    // Render pass and pipelines are built for the old format
+    if (swapChainImageFormat != oldFormat)
+        throw std::runtime_error("swap chain format changed on recreation!");
+
+    createImageViews();
+    createFramebuffers();
+    createSwapChainSyncObjects();
+
+    framebufferResized = false;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    lastRecreationTime = elapsed.count();
+    swapChainRecreated = true;
+}
+
+void HelloTriangleApplication::destroyRetiredSwapChain(RetiredSwapChain &retired)
+{
+    for (auto framebuffer : retired.framebuffers)
+        vkDestroyFramebuffer(device, framebuffer, allocationCallbacks);
+
+    for (auto imageView : retired.imageViews)
+        vkDestroyImageView(device, imageView, allocationCallbacks);
+
+    for (auto semaphore : retired.renderFinishedSemaphores)
+        vkDestroySemaphore(device, semaphore, allocationCallbacks);
+
+    vkDestroySwapchainKHR(device, retired.swapChain, allocationCallbacks);
+}
+
+void HelloTriangleApplication::destroyFinishedRetiredSwapChains()
+{
+    auto finished = [this](RetiredSwapChain &retired)
+    {
+        if (submittedFrames < retired.retiredAtFrame + config.framesInFlight)
+            return false;
+
+        destroyRetiredSwapChain(retired);
+        return true;
+    };
+
+    retiredSwapChains.erase(std::remove_if(retiredSwapChains.begin(), retiredSwapChains.end(), finished),
+                            retiredSwapChains.end());
+}
+
+void HelloTriangleApplication::drawFrame()
+{
+    if (config.headless)
+    {
+        drawOffscreenFrame();
+        return;
+    }
+
+    // Low latency policy blocks first and polls input as late as possible, right before recording.
+    // Others poll first, so CPU work overlaps GPU and waiting happens only when frame resources are needed.
+    if (config.presentPolicy != PresentPolicy::LowLatency)
+        sampleInput();
+
+    waitForFrameFence();
+
+    destroyFinishedRetiredSwapChains();
+
+    uint32_t imageIndex;
+    VkResult result;
+    {
+        CpuZone zone("acquire image");
+        result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame],
+                                       VK_NULL_HANDLE, &imageIndex);
+    }
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        // Semaphore isn't signaled and fence isn't reset, so frame can simply be retried
+        recreateSwapChain();
+        return;
+    }
+
+    // Suboptimal image was acquired and semaphore signaled, so it is still rendered and presented
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("failed to acquire swap chain image!");
+
+    // Swap chain may hand out images out of order, so image could still be used by another frame
+    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+    {
+        CpuZone zone("wait for image");
+        vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+    }
+    imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+
+    if (config.presentPolicy == PresentPolicy::LowLatency)
+        sampleInput();
+
+    simulateParticles();
+    updateFrameDescriptors();
+
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, 0);
+    recordCommandBuffer(commandBuffer, imageIndex, config.drawCount, commandRecorder.get());
+
+    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[imageIndex]};
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    submit(submitInfo);
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapChain;
+    presentInfo.pImageIndices = &imageIndex;
+
+    submittedFrames++;
+
+    {
+        CpuZone zone("present");
+        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    }
+
+    std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - inputSampleTime;
+    inputToPresentLatencies.push_back(latency.count());
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
+        recreateSwapChain();
+    else if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to present swap chain image!");
+
+    currentFrame = (currentFrame + 1) % config.framesInFlight;
+}
+
+void HelloTriangleApplication::waitForFrameFence()
+{
+    CpuZone zone("wait for frame");
+    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+}
+
+void HelloTriangleApplication::simulateParticles()
+{
+    if (!particles)
+        return;
+
+    CpuZone zone("simulate particles");
+
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<float> elapsed = now - lastParticleStepTime;
+    lastParticleStepTime = now;
+
+    // Long hitches are clamped, so particles don't jump through the edges
+    float deltaTime = particles->getStepCount() == 0 ? 1.0f / 60.0f : std::min(elapsed.count(), 0.05f);
+
+    particlesSemaphore = particles->step(static_cast<uint32_t>(currentFrame), deltaTime,
+                                         computeProfiler.get());
+}
+
+void HelloTriangleApplication::submit(const VkSubmitInfo &submitInfo)
+{
+    CpuZone zone("submit");
+
+    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+
+    // Draws wait for particles of this frame, everything before vertex input still overlaps simulation
+    std::vector<VkSemaphore> waitSemaphores(submitInfo.pWaitSemaphores,
+                                            submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount);
+    std::vector<VkPipelineStageFlags> waitStages(submitInfo.pWaitDstStageMask,
+                                                 submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount);
+    if (particlesSemaphore != VK_NULL_HANDLE)
+    {
+        waitSemaphores.push_back(particlesSemaphore);
+        waitStages.push_back(ParticleSimulation::CONSUMER_STAGES);
+        particlesSemaphore = VK_NULL_HANDLE;
+    }
+
+    VkSubmitInfo frameSubmitInfo = submitInfo;
+    frameSubmitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    frameSubmitInfo.pWaitSemaphores = waitSemaphores.data();
+    frameSubmitInfo.pWaitDstStageMask = waitStages.data();
+
+    VkResult result = vkQueueSubmit(graphicsQueue, 1, &frameSubmitInfo, inFlightFences[currentFrame]);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to submit draw command buffer!");
+}
+
+void HelloTriangleApplication::sampleInput()
+{
+    CpuZone zone("poll input");
+
+    glfwPollEvents();
+    inputSampleTime = std::chrono::steady_clock::now();
+}
+
+void HelloTriangleApplication::drawOffscreenFrame()
+{
+    waitForFrameFence();
+
+    // Every frame in flight owns its target, so fence alone protects it
+    uint32_t imageIndex = static_cast<uint32_t>(currentFrame);
+
+    simulateParticles();
+    updateFrameDescriptors();
+
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, 0);
+    recordCommandBuffer(commandBuffer, imageIndex, config.drawCount, commandRecorder.get());
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    submit(submitInfo);
+
+    currentFrame = (currentFrame + 1) % config.framesInFlight;
+}
@@ -0,0 +1,490 @@
+#ifndef HELLO_VULKAN_HELLO_TRIANGLE_APPLICATION_H
+#define HELLO_VULKAN_HELLO_TRIANGLE_APPLICATION_H
+
+#define GLFW_INCLUDE_VULKAN
+
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <optional>
+#include <set>
+#include <string>
+#include <chrono>
+#include <memory>
+
+#include "utils/shader_library.h"
+#include "utils/thread_pool.h"
+#include "utils/pipeline_builder.h"
+#include "utils/pipeline_registry.h"
+#include "utils/vertex.h"
+#include "utils/device_memory_allocator.h"
+#include "utils/app_config.h"
+#include "utils/vk_pipeline_cache.h"
+#include "utils/async_uploader.h"
+#include "utils/parallel_command_recorder.h"
+#include "utils/gpu_profiler.h"
+#include "utils/device_capabilities.h"
+#include "utils/host_allocator.h"
+#include "utils/descriptor_layout_cache.h"
+#include "utils/frame_descriptor_allocator.h"
+#include "utils/bindless_descriptor_table.h"
+#include "utils/gpu_culler.h"
+#include "utils/particle_simulation.h"
+
+
+class HelloTriangleApplication
+{
+    public:
+
+        const uint32_t WIDTH = 800;
+        const uint32_t HEIGHT = 600;
+
+        const std::vector<const char *> validationLayers =
+                {
+                        "VK_LAYER_KHRONOS_validation"
+                };
+
+        const std::vector<const char *> deviceExtensions =
+                {
+                        VK_KHR_SWAPCHAIN_EXTENSION_NAME
+                };
+
+
+#ifdef NDEBUG
+        const bool enableValidationLayers = false;
+#else
+        const bool enableValidationLayers = true;
+#endif
+
+
+        // Single triangle, or grid of config.triangleCount smaller ones
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        // Grid of config.instanceCount placements of the mesh above
+        std::vector<Instance> instances;
+
+        // Filled by run(), milliseconds
+        struct RunStats
+        {
+            double initTime = 0.0;
+            double mainLoopTime = 0.0;
+            std::vector<double> frameTimes;
+        };
+
+
+        explicit HelloTriangleApplication(const AppConfig &config);
+
+        const RunStats &getRunStats() const
+        { return runStats; }
+
+        void run();
+
+
+    private:
+
+        AppConfig config;
+        RunStats runStats;
+
+        // Host memory behind every Vulkan object, has to outlive all of them
+        HostAllocator hostAllocator;
+
+        // Passed to every vkCreate*/vkDestroy* call, null when driver allocates host memory itself
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        GLFWwindow *window = nullptr;
+        VkInstance instance;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkDevice device;
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
+
+        // Queried once per physical device, instead of every time swap chain or queues are set up
+        DeviceCapabilityCache deviceCapabilities;
+
+        VkQueue graphicsQueue;
+        VkQueue presentQueue;
+
+        // Same as graphics queue when device has no separate transfer family
+        VkQueue transferQueue;
+        uint32_t transferFamily;
+
+        // Same as graphics queue when device has no compute-only family or async compute is off
+        VkQueue computeQueue;
+        uint32_t computeFamily;
+
+        VkSwapchainKHR swapChain;
+        std::vector<VkImage> swapChainImages;
+        VkFormat swapChainImageFormat;
+        VkExtent2D swapChainExtent;
+        std::vector<VkImageView> swapChainImageViews;
+
+        // Headless mode renders into these instead of swap chain images, one per frame in flight
+        std::vector<DeviceAllocation> offscreenImagesMemory;
+
+        VkRenderPass renderPass;
+        VkPipelineLayout pipelineLayout;
+
+        VkPipeline graphicsPipeline;
+
+        // Extra copies of graphicsPipeline for --pipelines, draws cycle through all of them
+        std::vector<VkPipeline> pipelineVariants;
+
+        std::unique_ptr<ThreadPool> threadPool;
+        std::unique_ptr<DeviceMemoryAllocator> memoryAllocator;
+        std::unique_ptr<ShaderLibrary> shaderLibrary;
+        std::unique_ptr<PipelineBuilder> pipelineBuilder;
+        std::unique_ptr<PipelineRegistry> pipelineRegistry;
+        std::unique_ptr<AsyncUploader> uploader;
+
+        VkPipelineCache pipelineCache;
+        bool pipelineCacheWarm = false;
+
+        std::vector<VkFramebuffer> swapChainFramebuffers;
+        VkCommandPool commandPool;
+
+        // Only exists when recording is spread over worker threads
+        std::unique_ptr<ParallelCommandRecorder> commandRecorder;
+
+        // Only exists when GPU profile is requested
+        std::unique_ptr<GpuProfiler> gpuProfiler;
+
+        // Device local, filled through staging buffers on transfer queue
+        VkBuffer vertexBuffer;
+        DeviceAllocation vertexBufferMemory;
+        VkBuffer indexBuffer;
+        DeviceAllocation indexBufferMemory;
+        VkBuffer instanceBuffer;
+        DeviceAllocation instanceBufferMemory;
+
+        // Only for indirect draw mode: one VkDrawIndexedIndirectCommand per instance, or a single one covering
+        // all of them when device can't start indirect draws at arbitrary instance
+        VkBuffer indirectBuffer = VK_NULL_HANDLE;
+        DeviceAllocation indirectBufferMemory;
+        uint32_t indirectCommandCount = 0;
+
+        // One without multiDrawIndirect, otherwise limited by maxDrawIndirectCount
+        uint32_t maxIndirectDrawsPerCall = 1;
+
+        // Only exists with --gpu-culling, replaces indirectBuffer with commands written by compute pass every frame
+        std::unique_ptr<GpuCuller> culler;
+
+        // Device got VK_KHR_draw_indirect_count, so culler can hand over just the survivors
+        bool drawIndirectCountEnabled = false;
+
+        // Only exists with --particles, its current buffer replaces instanceBuffer
+        std::unique_ptr<ParticleSimulation> particles;
+
+        // Signaled by this frame's simulation step, waited on by its graphics submission
+        VkSemaphore particlesSemaphore = VK_NULL_HANDLE;
+        std::chrono::steady_clock::time_point lastParticleStepTime;
+
+        // Timestamps of compute queue, only exists with both GPU profile and particles
+        std::unique_ptr<GpuProfiler> computeProfiler;
+
+        // Shader visible data which changes every frame, std140 layout
+        struct FrameUniforms
+        {
+            float tint[4];
+
+            // Camera center in xy, zoom in zw
+            float view[4];
+
+            // Left, right, bottom, top: xyz is inward normal, w distance, so inside means dot(xyz, p) + w >= 0
+            float frustumPlanes[4][4];
+
+            float time;
+        };
+
+        std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache;
+        std::unique_ptr<FrameDescriptorAllocator> frameDescriptorAllocator;
+        VkDescriptorSetLayout frameSetLayout;
+
+        // Only exists with --bindless on devices supporting descriptor indexing, frame sets are not used then
+        std::unique_ptr<BindlessDescriptorTable> bindlessTable;
+        bool useBindless = false;
+
+        // Per frame in flight, host visible and persistently mapped
+        std::vector<VkBuffer> frameUniformBuffers;
+        std::vector<DeviceAllocation> frameUniformMemory;
+        std::vector<uint32_t> frameUniformIndices;  // into bindless table
+
+        // Set of the frame being recorded, allocated and written once per frame before recording starts
+        VkDescriptorSet frameDescriptorSet = VK_NULL_HANDLE;
+
+        // Frame uniforms carry time since then
+        std::chrono::steady_clock::time_point runStartTime;
+
+        // Per frame in flight: CPU records frame N+1 while GPU is still busy with frame N
+        std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<VkSemaphore> imageAvailableSemaphores;
+        std::vector<VkFence> inFlightFences;
+
+        // Per swap chain image: presentation engine may hold semaphore longer than one frame
+        std::vector<VkSemaphore> renderFinishedSemaphores;
+        std::vector<VkFence> imagesInFlight;
+
+        size_t currentFrame = 0;
+
+        // Frames submitted so far, tells when retired swap chain resources are no longer used
+        uint64_t submittedFrames = 0;
+
+        // Not every platform reports VK_ERROR_OUT_OF_DATE_KHR on resize, so GLFW callback is tracked too
+        bool framebufferResized = false;
+
+        // Old swap chain stays alive until frames which rendered into it are finished,
+        // so recreation doesn't have to wait for idle device
+        struct RetiredSwapChain
+        {
+            VkSwapchainKHR swapChain;
+            std::vector<VkImageView> imageViews;
+            std::vector<VkFramebuffer> framebuffers;
+            std::vector<VkSemaphore> renderFinishedSemaphores;
+            uint64_t retiredAtFrame;
+        };
+        std::vector<RetiredSwapChain> retiredSwapChains;
+
+        // Set by recreateSwapChain(), so main loop can tell how long the whole frame took
+        bool swapChainRecreated = false;
+        double lastRecreationTime = 0.0;
+
+        // When input for the frame being recorded was polled, and how long it took from there to vkQueuePresentKHR
+        std::chrono::steady_clock::time_point inputSampleTime;
+        std::vector<double> inputToPresentLatencies;
+
+        // Seconds of CPU time spent recording command buffers since main loop started
+        double recordingTime = 0.0;
+
+        VkDebugUtilsMessengerEXT debugMessenger;
+
+
+        void initWindow();
+
+        static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
+
+        void initVulkan();
+
+        void mainLoop();
+
+        // foo.json becomes foo.compute.json
+        std::string getComputeProfilePath() const;
+
+        void printLatencyStats();
+
+        // CPU-only sweep over draw and thread counts. Command buffers are recorded and thrown away,
+        // nothing is submitted, so numbers show pure recording throughput.
+        void runRecordingBenchmark();
+
+        void cleanup();
+
+
+        void createInstance();
+
+        void printAvailableExtensions();
+
+        bool checkValidationLayerSupport();
+
+        std::vector<const char *> getRequiredExtensions();
+
+        static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
+                VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+                VkDebugUtilsMessageTypeFlagsEXT messageType,
+                const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
+                void *pUserData
+        );
+
+        void setupDebugMessenger();
+
+        VkDebugUtilsMessengerCreateInfoEXT createDebugMessengerCreateInfo();
+
+        void createSurface();
+
+        void pickPhysicalDevice();
+
+        const DeviceCapabilities &getCapabilities(VkPhysicalDevice device);
+
+        // Hard requirements only, preferences are up to rateDevice()
+        bool isDeviceSuitable(VkPhysicalDevice device);
+
+        // Device type dominates, then memory, limits and nice-to-have features only break ties,
+        // so integrated GPU never wins over discrete one just by sharing plenty of system RAM
+        uint64_t rateDevice(VkPhysicalDevice device);
+
+        std::vector<const char *> getRequiredDeviceExtensions();
+
+        bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+
+        struct QueueFamilyIndices
+        {
+            // Not all queues support graphics AND presentation on our surface
+            std::optional<uint32_t> graphicsFamily;
+            std::optional<uint32_t> presentFamily;
+
+            // Separate family for uploads, so copies don't occupy graphics queue. Optional,
+            // graphics family can always transfer too
+            std::optional<uint32_t> transferFamily;
+
+            // Family without graphics for async compute, so compute work runs alongside graphics pass. Optional,
+            // graphics family can always compute too
+            std::optional<uint32_t> computeFamily;
+
+            // There is nothing to present to without a surface
+            bool presentRequired = true;
+
+            bool isComplete()
+            {
+                return
+                        graphicsFamily.has_value() &&
+                        (presentFamily.has_value() || !presentRequired);
+            }
+
+            std::set<uint32_t> getUniqueQueues()
+            {
+                if (!isComplete())
+                    throw std::runtime_error("Trying to use incomplete queue set");
+
+                std::set<uint32_t> uniqueQueues = {graphicsFamily.value()};
+                if (presentFamily.has_value())
+                    uniqueQueues.insert(presentFamily.value());
+                if (transferFamily.has_value())
+                    uniqueQueues.insert(transferFamily.value());
+                if (computeFamily.has_value())
+                    uniqueQueues.insert(computeFamily.value());
+
+                return uniqueQueues;
+            }
+        };
+
+        // Cheap, both queue families and present support come from capability snapshot
+        QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
+
+        void createLogicalDevice();
+
+        struct SwapChainSupportDetails
+        {
+            VkSurfaceCapabilitiesKHR capabilities;
+            std::vector<VkSurfaceFormatKHR> formats;
+            std::vector<VkPresentModeKHR> presentModes;
+        };
+
+        SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
+
+        VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
+
+        VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes);
+
+        uint32_t chooseSwapImageCount(const VkSurfaceCapabilitiesKHR &capabilities);
+
+        static const char *presentModeName(VkPresentModeKHR presentMode);
+
+        VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
+
+        void createSwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
+
+        void createMemoryAllocator();
+
+        void createOffscreenImages();
+
+        void createImageViews();
+
+        void createGraphicsPipeline();
+
+        void createPipelineCache();
+
+        void createShaderLibrary();
+
+        void createRenderPass();
+
+        void createFramebuffers();
+
+        void createCommandPool();
+
+        VkBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                              DeviceAllocation &bufferMemory);
+
+        void createUploader();
+
+        // Device local memory is the fastest for GPU to read, but usually not visible to CPU,
+        // so data goes through temporary host visible staging buffer
+        void createDeviceLocalBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage,
+                                     VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                                     VkBuffer &buffer, DeviceAllocation &bufferMemory);
+
+        void generateGeometry();
+
+        void generateInstances();
+
+        void createVertexBuffer();
+
+        void createIndexBuffer();
+
+        void createInstanceBuffer();
+
+        void createCuller();
+
+        void createParticleSimulation();
+
+        // Placements the draws of current frame read
+        VkBuffer getInstanceBuffer() const;
+
+        void createIndirectBuffer();
+
+        void createCommandBuffers();
+
+        void createGpuProfiler();
+
+        // Secondary command buffers inherit nothing but render pass, so everything is bound in every partition
+        void createDescriptorResources();
+
+        void createFrameUniformBuffers();
+
+        // Called once per frame after its fence is waited for, draws only bind what is written here
+        void updateFrameDescriptors();
+
+        // Camera pans over instance grid, which spans [-1, 1] on both axes. Without zoom it sees the whole grid
+        // and stays put.
+        void updateCamera(FrameUniforms &uniforms, float time) const;
+
+        // Once per command buffer, secondary ones inherit nothing
+        void bindFrameDescriptors(VkCommandBuffer commandBuffer);
+
+        // Draws [first, first + drawCount) of the frame, so variant of every draw doesn't depend on how
+        // draws were partitioned between command buffers
+        void recordDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t drawCount);
+
+        // Puts every instance on screen once
+        void drawObjects(VkCommandBuffer commandBuffer);
+
+        uint32_t getObjectDrawCallCount() const;
+
+        void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t drawCount,
+                                 ParallelCommandRecorder *recorder);
+
+        void createSyncObjects();
+
+        void createSwapChainSyncObjects();
+
+        // Only resources depending on swap chain images are rebuilt. Extent is dynamic state, so pipelines stay.
+        void recreateSwapChain();
+
+        void destroyRetiredSwapChain(RetiredSwapChain &retired);
+
+        // Fence of current frame was waited on, so every frame submitted framesInFlight frames ago is finished
+        void destroyFinishedRetiredSwapChains();
+
+        void drawFrame();
+
+        void waitForFrameFence();
+
+        // Submits this frame's step on compute queue, so it runs while graphics queue still works on previous frame
+        void simulateParticles();
+
+        void submit(const VkSubmitInfo &submitInfo);
+
+        void sampleInput();
+
+        void drawOffscreenFrame();
+
+};
+
+#endif //HELLO_VULKAN_HELLO_TRIANGLE_APPLICATION_H
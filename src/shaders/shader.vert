@@ -1,24 +1,29 @@
 #version 450
 
-vec2 positions[3] = vec2[]
-(
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
 
-vec3 colors[3] = vec3[]
-(
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(location = 2) in vec2 inInstanceOffset;
+layout(location = 3) in float inInstanceScale;
+layout(location = 4) in vec3 inInstanceColor;
+
+// Written once per frame, shared by every draw
+layout(set = 0, binding = 0) uniform FrameUniforms
+{
+    vec4 tint;
+    vec4 view;  // camera center in xy, zoom in zw
+    vec4 frustumPlanes[4];
+    float time;
+} frame;
 
 
 layout(location = 0) out vec3 fragColor;
 
 void main() 
 {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    vec2 world = inPosition * inInstanceScale + inInstanceOffset;
+    vec4 view = frame.view;
+
+    gl_Position = vec4((world - view.xy) * view.zw, 0.0, 1.0);
+    fragColor = inColor * inInstanceColor * frame.tint.rgb;
 }
@@ -0,0 +1,35 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 2) in vec2 inInstanceOffset;
+layout(location = 3) in float inInstanceScale;
+layout(location = 4) in vec3 inInstanceColor;
+
+// Every storage buffer of the application, frame picks its own through push constant
+layout(set = 0, binding = 0) readonly buffer FrameUniforms
+{
+    vec4 tint;
+    vec4 view;  // camera center in xy, zoom in zw
+    vec4 frustumPlanes[4];
+    float time;
+} frames[];
+
+layout(push_constant) uniform PushConstants
+{
+    uint frameIndex;
+} push;
+
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    vec2 world = inPosition * inInstanceScale + inInstanceOffset;
+    vec4 view = frames[push.frameIndex].view;
+
+    gl_Position = vec4((world - view.xy) * view.zw, 0.0, 1.0);
+    fragColor = inColor * inInstanceColor * frames[push.frameIndex].tint.rgb;
+}
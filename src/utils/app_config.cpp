@@ -0,0 +1,270 @@
+#include "app_config.h"
+
+#include <cctype>
+#include <limits>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+uint32_t parseUnsigned(const std::string &option, const char *value)
+{
+    if (value == nullptr)
+    {
+        std::stringstream error_message;
+        error_message << "missing value for " << option << "!";
+        throw std::runtime_error(error_message.str());
+    }
+
+    // std::stoul skips whitespace and wraps negative numbers around, so only plain digits get to it
+    try
+    {
+        size_t parsed = 0;
+        unsigned long result = std::isdigit(static_cast<unsigned char>(value[0])) ? std::stoul(value, &parsed) : 0;
+
+        if (parsed > 0 && parsed == std::string(value).size() && result <= std::numeric_limits<uint32_t>::max())
+            return static_cast<uint32_t>(result);
+    }
+    catch (const std::logic_error &)
+    {
+        // Reported below together with malformed input
+    }
+
+    std::stringstream error_message;
+    error_message << "invalid value '" << value << "' for " << option << "!";
+    throw std::runtime_error(error_message.str());
+}
+
+const char *presentPolicyName(PresentPolicy policy)
+{
+    switch (policy)
+    {
+        case PresentPolicy::LowLatency:
+            return "low-latency";
+        case PresentPolicy::Throughput:
+            return "throughput";
+        case PresentPolicy::PowerSaving:
+            return "power-saving";
+    }
+
+    return "unknown";
+}
+
+static PresentPolicy parsePresentPolicy(const std::string &option, const char *value)
+{
+    if (value == nullptr)
+        throw std::runtime_error("missing value for " + option + "!");
+
+    for (auto policy : {PresentPolicy::LowLatency, PresentPolicy::Throughput, PresentPolicy::PowerSaving})
+        if (presentPolicyName(policy) == std::string(value))
+            return policy;
+
+    std::stringstream error_message;
+    error_message << "invalid value '" << value << "' for " << option
+                  << ", expected low-latency, throughput or power-saving!";
+    throw std::runtime_error(error_message.str());
+}
+
+const char *drawModeName(DrawMode mode)
+{
+    switch (mode)
+    {
+        case DrawMode::PerObject:
+            return "per-object";
+        case DrawMode::Instanced:
+            return "instanced";
+        case DrawMode::Indirect:
+            return "indirect";
+    }
+
+    return "unknown";
+}
+
+static DrawMode parseDrawMode(const std::string &option, const char *value)
+{
+    if (value == nullptr)
+        throw std::runtime_error("missing value for " + option + "!");
+
+    for (auto mode : {DrawMode::PerObject, DrawMode::Instanced, DrawMode::Indirect})
+        if (drawModeName(mode) == std::string(value))
+            return mode;
+
+    std::stringstream error_message;
+    error_message << "invalid value '" << value << "' for " << option
+                  << ", expected per-object, instanced or indirect!";
+    throw std::runtime_error(error_message.str());
+}
+
+AppConfig parseCommandLine(int argc, char **argv)
+{
+    AppConfig config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (option == "--frames-in-flight")
+        {
+            config.framesInFlight = parseUnsigned(option, value);
+            if (config.framesInFlight == 0)
+                throw std::runtime_error("--frames-in-flight must be at least 1!");
+            i++;
+        }
+        else if (option == "--present-policy")
+        {
+            config.presentPolicy = parsePresentPolicy(option, value);
+            i++;
+        }
+        else if (option == "--frames")
+        {
+            config.frameLimit = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--headless")
+        {
+            config.headless = true;
+        }
+        else if (option == "--gpu")
+        {
+            if (value == nullptr)
+                throw std::runtime_error("missing value for --gpu!");
+
+            config.gpuSelector = value;
+            i++;
+        }
+        else if (option == "--pipeline-cache")
+        {
+            if (value == nullptr)
+                throw std::runtime_error("missing value for --pipeline-cache!");
+
+            config.pipelineCachePath = value;
+            i++;
+        }
+        else if (option == "--no-pipeline-cache")
+        {
+            config.pipelineCachePath.clear();
+        }
+        else if (option == "--shader-dir")
+        {
+            if (value == nullptr)
+                throw std::runtime_error("missing value for --shader-dir!");
+
+            config.shaderDirectory = value;
+            i++;
+        }
+        else if (option == "--threads")
+        {
+            config.workerThreads = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--draws")
+        {
+            config.drawCount = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--triangles")
+        {
+            config.triangleCount = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--instances")
+        {
+            config.instanceCount = parseUnsigned(option, value);
+            if (config.instanceCount == 0)
+                throw std::runtime_error("--instances must be at least 1!");
+            i++;
+        }
+        else if (option == "--draw-mode")
+        {
+            config.drawMode = parseDrawMode(option, value);
+            i++;
+        }
+        else if (option == "--gpu-culling")
+        {
+            config.gpuCulling = true;
+        }
+        else if (option == "--zoom")
+        {
+            config.zoom = parseUnsigned(option, value);
+            if (config.zoom == 0)
+                throw std::runtime_error("--zoom must be at least 1!");
+            i++;
+        }
+        else if (option == "--particles")
+        {
+            config.particles = true;
+        }
+        else if (option == "--no-async-compute")
+        {
+            config.asyncCompute = false;
+        }
+        else if (option == "--pipelines")
+        {
+            config.pipelineCount = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--record-threads")
+        {
+            config.recordThreads = parseUnsigned(option, value);
+            i++;
+        }
+        else if (option == "--gpu-profile")
+        {
+            if (value == nullptr)
+                throw std::runtime_error("missing value for --gpu-profile!");
+
+            config.gpuProfilePath = value;
+            i++;
+        }
+        else if (option == "--cpu-profile")
+        {
+            if (value == nullptr)
+                throw std::runtime_error("missing value for --cpu-profile!");
+
+            config.cpuProfilePath = value;
+            i++;
+        }
+        else if (option == "--benchmark-recording")
+        {
+            config.recordingBenchmark = true;
+        }
+        else if (option == "--bindless")
+        {
+            config.bindless = true;
+        }
+        else if (option == "--default-host-allocator")
+        {
+            config.defaultHostAllocator = true;
+        }
+        else
+        {
+            std::stringstream error_message;
+            error_message << "unknown option " << option << "!";
+            throw std::runtime_error(error_message.str());
+        }
+    }
+
+    if (config.framesInFlight == 0)
+    {
+        switch (config.presentPolicy)
+        {
+            case PresentPolicy::LowLatency:
+                config.framesInFlight = 1;
+                break;
+            case PresentPolicy::Throughput:
+                config.framesInFlight = 3;
+                break;
+            case PresentPolicy::PowerSaving:
+                config.framesInFlight = 2;
+                break;
+        }
+    }
+
+    if (config.gpuCulling)
+        config.drawMode = DrawMode::Indirect;
+
+    if (config.headless && config.frameLimit == 0)
+        config.frameLimit = DEFAULT_HEADLESS_FRAME_LIMIT;
+
+    return config;
+}
@@ -0,0 +1,121 @@
+#ifndef HELLO_VULKAN_APP_CONFIG_H
+#define HELLO_VULKAN_APP_CONFIG_H
+
+#include <cstdint>
+#include <string>
+
+// Trade-off between latency, throughput and power when presenting
+enum class PresentPolicy
+{
+    // IMMEDIATE or MAILBOX, as few images as possible, one frame in flight, input sampled right before recording
+    LowLatency,
+
+    // MAILBOX or IMMEDIATE, two spare images and three frames in flight, so CPU and GPU never wait for each other
+    Throughput,
+
+    // FIFO_RELAXED or FIFO, one spare image and two frames in flight, GPU renders no more frames than display shows
+    PowerSaving
+};
+
+const char *presentPolicyName(PresentPolicy policy);
+
+// How every draw puts its set of object instances on screen
+enum class DrawMode
+{
+    // One vkCmdDrawIndexed per object
+    PerObject,
+
+    // One vkCmdDrawIndexed for all objects, placement comes from per-instance attributes
+    Instanced,
+
+    // One indirect command per object in a device local buffer, consumed by as few vkCmdDrawIndexedIndirect
+    // calls as maxDrawIndirectCount allows
+    Indirect
+};
+
+const char *drawModeName(DrawMode mode);
+
+struct AppConfig
+{
+    // How many frames CPU is allowed to record ahead of GPU, zero means default of present policy
+    uint32_t framesInFlight = 0;
+
+    PresentPolicy presentPolicy = PresentPolicy::Throughput;
+
+    // Zero means "render until window is closed"
+    uint32_t frameLimit = 0;
+
+    // Device name part or UUID, empty means best scoring device
+    std::string gpuSelector;
+
+    // Render into offscreen images without GLFW, window or swap chain
+    bool headless = false;
+
+    // Pipeline cache is loaded from and saved back to this file, empty path disables persistence
+    std::string pipelineCachePath = "pipeline_cache.bin";
+
+    // *.spv files here replace shaders embedded into the binary, so shaders can be iterated on without rebuilding.
+    // Empty path means embedded shaders only.
+    std::string shaderDirectory;
+
+    // Worker threads for parallel jobs like pipeline compilation, zero means one per hardware thread
+    uint32_t workerThreads = 0;
+
+    // Identical draws per frame, to put some load on command recording
+    uint32_t drawCount = 1;
+
+    // Triangles drawn by every draw, laid out in a grid
+    uint32_t triangleCount = 1;
+
+    // Copies of the mesh every draw puts on screen, laid out in a grid
+    uint32_t instanceCount = 1;
+
+    DrawMode drawMode = DrawMode::Instanced;
+
+    // Objects are culled against camera frustum by a compute pass writing indirect commands, implies indirect mode
+    bool gpuCulling = false;
+
+    // Camera zoom, at N only about 1/N^2 of the object grid is in view while camera pans over it
+    uint32_t zoom = 1;
+
+    // Instances are moved every frame by a particle simulation in compute shader
+    bool particles = false;
+
+    // Compute work is submitted to a dedicated compute queue family when device has one, so it overlaps graphics.
+    // Otherwise it goes to graphics queue.
+    bool asyncCompute = true;
+
+    // Identical graphics pipelines compiled without cache, draws cycle through them
+    uint32_t pipelineCount = 1;
+
+    // Zero records inline on main thread, otherwise secondary command buffers are recorded in up to N partitions
+    uint32_t recordThreads = 0;
+
+    // Per-pass GPU timings are written here on exit, as CSV for .csv extension and Chrome trace JSON otherwise.
+    // Empty path disables profiling.
+    std::string gpuProfilePath;
+
+    // Chrome trace JSON of CPU zones covering init steps and frame phases is written here on exit.
+    // Empty path disables instrumentation.
+    std::string cpuProfilePath;
+
+    // Measure recording time for several draw and thread counts instead of rendering
+    bool recordingBenchmark = false;
+
+    // Shaders reach per-frame data through one descriptor indexing table instead of per-frame descriptor sets,
+    // falls back to the latter when device lacks VK_EXT_descriptor_indexing
+    bool bindless = false;
+
+    // Leave host memory of Vulkan objects to the driver instead of our pooled allocator, for comparison
+    bool defaultHostAllocator = false;
+};
+
+// Headless run has no window to close, so it needs some finite amount of frames
+const uint32_t DEFAULT_HEADLESS_FRAME_LIMIT = 1000;
+
+AppConfig parseCommandLine(int argc, char **argv);
+
+// Value of a numeric option, anything but plain digits fitting into uint32_t throws
+uint32_t parseUnsigned(const std::string &option, const char *value);
+
+#endif //HELLO_VULKAN_APP_CONFIG_H
@@ -0,0 +1,314 @@
+#include "async_uploader.h"
+#include "cpu_profiler.h"
+
+#include <cstring>
+#include <stdexcept>
+
+AsyncUploader::AsyncUploader(VkDevice device, DeviceMemoryAllocator &allocator,
+                             VkQueue transferQueue, uint32_t transferFamily,
+                             VkQueue graphicsQueue, uint32_t graphicsFamily,
+                             const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks),
+        allocator(allocator),
+        transferQueue(transferQueue),
+        transferFamily(transferFamily),
+        graphicsQueue(graphicsQueue),
+        graphicsFamily(graphicsFamily)
+{
+    transferCommandPool = createCommandPool(transferFamily);
+
+    if (usesDedicatedQueue())
+        acquireCommandPool = createCommandPool(graphicsFamily);
+}
+
+AsyncUploader::~AsyncUploader()
+{
+    waitIdle();
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (auto &copy : pending)
+        allocator.destroyBuffer(copy.stagingBuffer, copy.stagingMemory);
+
+    for (auto semaphore : freeSemaphores)
+        vkDestroySemaphore(device, semaphore, allocationCallbacks);
+
+    for (auto fence : freeFences)
+        vkDestroyFence(device, fence, allocationCallbacks);
+
+    if (acquireCommandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(device, acquireCommandPool, allocationCallbacks);
+
+    vkDestroyCommandPool(device, transferCommandPool, allocationCallbacks);
+}
+
+void AsyncUploader::enqueue(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size,
+                            VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    PendingCopy copy{};
+    copy.dstBuffer = dstBuffer;
+    copy.dstOffset = dstOffset;
+    copy.size = size;
+    copy.dstStageMask = dstStageMask;
+    copy.dstAccessMask = dstAccessMask;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    copy.stagingBuffer = allocator.createBuffer(bufferInfo,
+                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                copy.stagingMemory);
+
+    memcpy(copy.stagingMemory.mapped, data, (size_t) size);
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back(copy);
+}
+
+bool AsyncUploader::submit()
+{
+    CpuZone zone("submit uploads");
+
+    Batch batch;
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        batch.copies.swap(pending);
+    }
+
+    if (batch.copies.empty())
+        return false;
+
+    VkPipelineStageFlags dstStages = 0;
+
+    batch.transferCommandBuffer = beginCommandBuffer(transferCommandPool);
+
+    std::vector<VkBufferMemoryBarrier> releaseBarriers;
+    std::vector<VkBufferMemoryBarrier> acquireBarriers;
+
+    for (const auto &copy : batch.copies)
+    {
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = 0;
+        copyRegion.dstOffset = copy.dstOffset;
+        copyRegion.size = copy.size;
+        vkCmdCopyBuffer(batch.transferCommandBuffer, copy.stagingBuffer, copy.dstBuffer, 1, &copyRegion);
+
+        dstStages |= copy.dstStageMask;
+
+        // Release and acquire halves must describe the very same ownership transfer
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+        barrier.buffer = copy.dstBuffer;
+        barrier.offset = copy.dstOffset;
+        barrier.size = copy.size;
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        releaseBarriers.push_back(barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = copy.dstAccessMask;
+        acquireBarriers.push_back(barrier);
+    }
+
+    if (usesDedicatedQueue())
+    {
+        vkCmdPipelineBarrier(batch.transferCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(),
+                             0, nullptr);
+    }
+    else
+    {
+        // Later submissions may overlap this one, copies become visible to readers only through a barrier.
+        // No ownership changes hands on a single queue, so acquire halves work with families ignored.
+        for (auto &barrier : acquireBarriers)
+        {
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        }
+
+        vkCmdPipelineBarrier(batch.transferCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(),
+                             0, nullptr);
+    }
+
+    vkEndCommandBuffer(batch.transferCommandBuffer);
+
+    batch.fence = acquireFence();
+
+    VkSubmitInfo transferSubmit{};
+    transferSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    transferSubmit.commandBufferCount = 1;
+    transferSubmit.pCommandBuffers = &batch.transferCommandBuffer;
+
+    if (!usesDedicatedQueue())
+    {
+        // Same queue as rendering, barrier recorded above orders copies ahead of any later read
+        VkResult result = vkQueueSubmit(graphicsQueue, 1, &transferSubmit, batch.fence);
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("failed to submit upload batch!");
+
+        inFlight.push_back(std::move(batch));
+        return true;
+    }
+
+    batch.transferFinished = acquireSemaphore();
+    transferSubmit.signalSemaphoreCount = 1;
+    transferSubmit.pSignalSemaphores = &batch.transferFinished;
+
+    VkResult result = vkQueueSubmit(transferQueue, 1, &transferSubmit, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to submit upload batch!");
+
+    batch.acquireCommandBuffer = beginCommandBuffer(acquireCommandPool);
+
+    vkCmdPipelineBarrier(batch.acquireCommandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStages, 0,
+                         0, nullptr,
+                         static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(),
+                         0, nullptr);
+
+    vkEndCommandBuffer(batch.acquireCommandBuffer);
+
+    VkSubmitInfo acquireSubmit{};
+    acquireSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    acquireSubmit.waitSemaphoreCount = 1;
+    acquireSubmit.pWaitSemaphores = &batch.transferFinished;
+    acquireSubmit.pWaitDstStageMask = &dstStages;
+    acquireSubmit.commandBufferCount = 1;
+    acquireSubmit.pCommandBuffers = &batch.acquireCommandBuffer;
+
+    result = vkQueueSubmit(graphicsQueue, 1, &acquireSubmit, batch.fence);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to submit upload ownership acquire!");
+
+    inFlight.push_back(std::move(batch));
+    return true;
+}
+
+void AsyncUploader::collectFinished()
+{
+    // Batches finish in submission order
+    while (!inFlight.empty() && vkGetFenceStatus(device, inFlight.front().fence) == VK_SUCCESS)
+    {
+        release(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+void AsyncUploader::waitIdle()
+{
+    while (!inFlight.empty())
+    {
+        vkWaitForFences(device, 1, &inFlight.front().fence, VK_TRUE, UINT64_MAX);
+
+        release(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+VkCommandPool AsyncUploader::createCommandPool(uint32_t queueFamily)
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkCommandPool commandPool;
+
+    VkResult result = vkCreateCommandPool(device, &poolInfo, allocationCallbacks, &commandPool);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create upload command pool!");
+
+    return commandPool;
+}
+
+VkCommandBuffer AsyncUploader::beginCommandBuffer(VkCommandPool commandPool)
+{
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate upload command buffer!");
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    return commandBuffer;
+}
+
+VkSemaphore AsyncUploader::acquireSemaphore()
+{
+    if (!freeSemaphores.empty())
+    {
+        VkSemaphore semaphore = freeSemaphores.back();
+        freeSemaphores.pop_back();
+        return semaphore;
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkSemaphore semaphore;
+    if (vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &semaphore) != VK_SUCCESS)
+        throw std::runtime_error("failed to create upload semaphore!");
+
+    return semaphore;
+}
+
+VkFence AsyncUploader::acquireFence()
+{
+    if (!freeFences.empty())
+    {
+        VkFence fence = freeFences.back();
+        freeFences.pop_back();
+
+        vkResetFences(device, 1, &fence);
+        return fence;
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, allocationCallbacks, &fence) != VK_SUCCESS)
+        throw std::runtime_error("failed to create upload fence!");
+
+    return fence;
+}
+
+void AsyncUploader::release(Batch &batch)
+{
+    for (auto &copy : batch.copies)
+        allocator.destroyBuffer(copy.stagingBuffer, copy.stagingMemory);
+
+    vkFreeCommandBuffers(device, transferCommandPool, 1, &batch.transferCommandBuffer);
+
+    if (batch.acquireCommandBuffer != VK_NULL_HANDLE)
+        vkFreeCommandBuffers(device, acquireCommandPool, 1, &batch.acquireCommandBuffer);
+
+    // Acquire submission waited on semaphore and is finished, so semaphore is unsignaled and reusable
+    if (batch.transferFinished != VK_NULL_HANDLE)
+        freeSemaphores.push_back(batch.transferFinished);
+
+    freeFences.push_back(batch.fence);
+}
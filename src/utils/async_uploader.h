@@ -0,0 +1,104 @@
+#ifndef HELLO_VULKAN_ASYNC_UPLOADER_H
+#define HELLO_VULKAN_ASYNC_UPLOADER_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "device_memory_allocator.h"
+
+// Streams buffer data to device local memory on dedicated transfer queue, so copies run alongside rendering
+// instead of in front of it. Each batch is a transfer submission (copies + queue family release barriers)
+// signaling a binary semaphore, followed by a tiny graphics queue submission waiting on it and acquiring
+// ownership. Everything graphics queue executes afterwards sees uploaded data, so nobody has to wait on CPU.
+// When device has no separate transfer family, copies simply go to graphics queue without ownership transfer.
+//
+// enqueue() may be called from any thread, submit() and collectFinished() only from the thread that
+// submits to graphics queue, since queues are externally synchronized.
+class AsyncUploader
+{
+    public:
+
+        AsyncUploader(VkDevice device, DeviceMemoryAllocator &allocator,
+                      VkQueue transferQueue, uint32_t transferFamily,
+                      VkQueue graphicsQueue, uint32_t graphicsFamily,
+                      const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~AsyncUploader();
+
+        AsyncUploader(const AsyncUploader &) = delete;
+        AsyncUploader &operator=(const AsyncUploader &) = delete;
+
+        // Data is copied to staging memory immediately, caller may release it right after the call.
+        // Destination must be exclusive buffer created with VK_BUFFER_USAGE_TRANSFER_DST_BIT, first use of it
+        // happens at dstStageMask with dstAccessMask.
+        void enqueue(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size,
+                     VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+
+        // Submits everything enqueued so far, returns false if there was nothing to submit
+        bool submit();
+
+        // Releases staging memory and sync objects of batches GPU is done with, never blocks
+        void collectFinished();
+
+        void waitIdle();
+
+        bool usesDedicatedQueue() const
+        { return transferFamily != graphicsFamily; }
+
+    private:
+
+        struct PendingCopy
+        {
+            VkBuffer dstBuffer;
+            VkDeviceSize dstOffset;
+            VkDeviceSize size;
+            VkPipelineStageFlags dstStageMask;
+            VkAccessFlags dstAccessMask;
+
+            VkBuffer stagingBuffer;
+            DeviceAllocation stagingMemory;
+        };
+
+        struct Batch
+        {
+            std::vector<PendingCopy> copies;
+
+            VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+            VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+            VkSemaphore transferFinished = VK_NULL_HANDLE;
+
+            // Signaled by last submission of batch
+            VkFence fence = VK_NULL_HANDLE;
+        };
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+        DeviceMemoryAllocator &allocator;
+
+        VkQueue transferQueue;
+        uint32_t transferFamily;
+        VkQueue graphicsQueue;
+        uint32_t graphicsFamily;
+
+        VkCommandPool transferCommandPool;
+        VkCommandPool acquireCommandPool = VK_NULL_HANDLE;
+
+        std::mutex pendingMutex;
+        std::vector<PendingCopy> pending;
+
+        std::deque<Batch> inFlight;
+
+        std::vector<VkSemaphore> freeSemaphores;
+        std::vector<VkFence> freeFences;
+
+        VkCommandPool createCommandPool(uint32_t queueFamily);
+        VkCommandBuffer beginCommandBuffer(VkCommandPool commandPool);
+        VkSemaphore acquireSemaphore();
+        VkFence acquireFence();
+        void release(Batch &batch);
+};
+
+#endif //HELLO_VULKAN_ASYNC_UPLOADER_H
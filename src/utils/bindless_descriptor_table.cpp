@@ -0,0 +1,100 @@
+#include "bindless_descriptor_table.h"
+
+#include <stdexcept>
+
+BindlessDescriptorTable::BindlessDescriptorTable(VkDevice device, DescriptorLayoutCache &layoutCache,
+                                                 uint32_t capacity,
+                                                 const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks),
+        capacity(capacity)
+{
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = capacity;
+    binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+
+    VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                               VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
+
+    layout = layoutCache.getLayout({binding}, {bindingFlags},
+                                   VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT);
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = capacity;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, allocationCallbacks, &pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+    {
+        vkDestroyDescriptorPool(device, pool, allocationCallbacks);
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+    }
+}
+
+BindlessDescriptorTable::~BindlessDescriptorTable()
+{
+    // Layout belongs to the cache
+    vkDestroyDescriptorPool(device, pool, allocationCallbacks);
+}
+
+bool BindlessDescriptorTable::isSupported(const DeviceCapabilities &capabilities)
+{
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT &features = capabilities.descriptorIndexingFeatures;
+
+    return capabilities.supportsExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) &&
+           capabilities.features.shaderStorageBufferArrayDynamicIndexing &&
+           features.runtimeDescriptorArray &&
+           features.descriptorBindingPartiallyBound &&
+           features.descriptorBindingStorageBufferUpdateAfterBind;
+}
+
+void BindlessDescriptorTable::enableFeatures(VkPhysicalDeviceFeatures &features,
+                                             VkPhysicalDeviceDescriptorIndexingFeaturesEXT &indexingFeatures)
+{
+    features.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+
+    indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+}
+
+uint32_t BindlessDescriptorTable::addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    if (size == capacity)
+        throw std::runtime_error("bindless descriptor table is full!");
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = 0;
+    write.dstArrayElement = size;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+    return size++;
+}
@@ -0,0 +1,61 @@
+#ifndef HELLO_VULKAN_BINDLESS_DESCRIPTOR_TABLE_H
+#define HELLO_VULKAN_BINDLESS_DESCRIPTOR_TABLE_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "descriptor_layout_cache.h"
+#include "device_capabilities.h"
+
+// One descriptor set holding every storage buffer of the application in a big partially bound array.
+// Shaders pick buffers by index, usually taken from push constants, so the set is bound once per command buffer
+// and never reallocated. Slots are written once at registration: update-after-bind lets that happen while
+// the set is bound by frames still in flight, as long as those frames don't use the slot.
+class BindlessDescriptorTable
+{
+    public:
+
+        static const uint32_t DEFAULT_CAPACITY = 1024;
+
+        // Device has to be created with features from enableFeatures()
+        BindlessDescriptorTable(VkDevice device, DescriptorLayoutCache &layoutCache,
+                                uint32_t capacity = DEFAULT_CAPACITY,
+                                const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~BindlessDescriptorTable();
+
+        BindlessDescriptorTable(const BindlessDescriptorTable &) = delete;
+        BindlessDescriptorTable &operator=(const BindlessDescriptorTable &) = delete;
+
+        // VK_EXT_descriptor_indexing with runtime arrays, partial binding and update-after-bind storage buffers,
+        // plus core dynamic indexing, since shaders pick their buffer with a push constant
+        static bool isSupported(const DeviceCapabilities &capabilities);
+
+        // Fills features needed by table, indexing features are to be chained into VkDeviceCreateInfo::pNext
+        static void enableFeatures(VkPhysicalDeviceFeatures &features,
+                                   VkPhysicalDeviceDescriptorIndexingFeaturesEXT &indexingFeatures);
+
+        // Returns index shaders use to reach the buffer
+        uint32_t addStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+        VkDescriptorSetLayout getLayout() const
+        { return layout; }
+
+        VkDescriptorSet getSet() const
+        { return set; }
+
+        uint32_t getSize() const
+        { return size; }
+
+    private:
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+        uint32_t capacity;
+        uint32_t size = 0;
+
+        VkDescriptorSetLayout layout;
+        VkDescriptorPool pool;
+        VkDescriptorSet set;
+};
+
+#endif //HELLO_VULKAN_BINDLESS_DESCRIPTOR_TABLE_H
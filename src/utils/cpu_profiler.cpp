@@ -0,0 +1,175 @@
+#include "cpu_profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    struct Zone
+    {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Written by owning thread only. Count is published with release, so reader sees complete zones.
+    struct Chunk
+    {
+        static const uint32_t CAPACITY = 4096;
+
+        Zone zones[CAPACITY];
+        std::atomic<uint32_t> count{0};
+        std::atomic<Chunk *> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t id;
+        std::string name;
+
+        Chunk head;
+        Chunk *tail = &head;
+
+        ~ThreadBuffer()
+        {
+            Chunk *chunk = head.next.load();
+            while (chunk != nullptr)
+            {
+                Chunk *next = chunk->next.load();
+                delete chunk;
+                chunk = next;
+            }
+        }
+    };
+
+    // Buffers outlive their threads, so zones of finished workers are still exported
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    std::atomic<bool> enabled{false};
+
+    const auto processStart = std::chrono::steady_clock::now();
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    // Registration locks once per thread, every later access is lock-free
+    ThreadBuffer &threadBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+
+        if (buffer == nullptr)
+        {
+            auto &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+
+            reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = reg.buffers.back().get();
+            buffer->id = static_cast<uint32_t>(reg.buffers.size() - 1);
+            buffer->name = "thread " + std::to_string(buffer->id);
+        }
+
+        return *buffer;
+    }
+}
+
+void CpuProfiler::setEnabled(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::setThreadName(const std::string &name)
+{
+    ThreadBuffer &buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+void CpuProfiler::record(const char *name, uint64_t start, uint64_t end)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    Chunk *chunk = buffer.tail;
+
+    uint32_t count = chunk->count.load(std::memory_order_relaxed);
+    if (count == Chunk::CAPACITY)
+    {
+        auto next = new Chunk();
+        chunk->next.store(next, std::memory_order_release);
+
+        chunk = buffer.tail = next;
+        count = 0;
+    }
+
+    chunk->zones[count] = {name, start, end};
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+uint64_t CpuProfiler::now()
+{
+    auto elapsed = std::chrono::steady_clock::now() - processStart;
+
+    // Zero is reserved for "not measured" by CpuZone
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() + 1;
+}
+
+size_t CpuProfiler::exportChromeTrace(const std::string &filename)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open " + filename + " for CPU profile!");
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[";
+
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    size_t zoneCount = 0;
+    bool first = true;
+
+    for (const auto &buffer : reg.buffers)
+    {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->id
+             << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        first = false;
+
+        for (const Chunk *chunk = &buffer->head; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            uint32_t count = chunk->count.load(std::memory_order_acquire);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const Zone &zone = chunk->zones[i];
+
+                // Complete events, times in microseconds
+                file << ",\n{\"name\":\"" << zone.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+                     << buffer->id << ",\"ts\":" << zone.start / 1000.0
+                     << ",\"dur\":" << (zone.end - zone.start) / 1000.0 << "}";
+            }
+
+            zoneCount += count;
+        }
+    }
+
+    file << "\n]}\n";
+
+    return zoneCount;
+}
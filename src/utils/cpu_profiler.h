@@ -0,0 +1,56 @@
+#ifndef HELLO_VULKAN_CPU_PROFILER_H
+#define HELLO_VULKAN_CPU_PROFILER_H
+
+#include <cstdint>
+#include <string>
+
+// Process-wide CPU instrumentation. Every thread appends zones to its own buffer without any locking,
+// buffers are only read when trace is exported. Disabled profiler costs one relaxed atomic load per zone.
+class CpuProfiler
+{
+    public:
+
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        // Shown instead of numeric id in trace viewer
+        static void setThreadName(const std::string &name);
+
+        // Zone names must outlive profiler, string literals are expected
+        static void record(const char *name, uint64_t start, uint64_t end);
+
+        // Nanoseconds since process start
+        static uint64_t now();
+
+        // Chrome trace JSON, for chrome://tracing or Perfetto. Returns number of zones written.
+        // Zones still being recorded by other threads during export may be missed, but never torn.
+        static size_t exportChromeTrace(const std::string &filename);
+};
+
+// Measures its own lifetime
+class CpuZone
+{
+    public:
+
+        explicit CpuZone(const char *name) :
+                name(name),
+                start(CpuProfiler::isEnabled() ? CpuProfiler::now() : 0)
+        {
+        }
+
+        ~CpuZone()
+        {
+            if (start != 0)
+                CpuProfiler::record(name, start, CpuProfiler::now());
+        }
+
+        CpuZone(const CpuZone &) = delete;
+        CpuZone &operator=(const CpuZone &) = delete;
+
+    private:
+
+        const char *name;
+        uint64_t start;
+};
+
+#endif //HELLO_VULKAN_CPU_PROFILER_H
@@ -0,0 +1,118 @@
+#include "descriptor_layout_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+static void hashCombine(size_t &seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool DescriptorSetLayoutKey::operator==(const DescriptorSetLayoutKey &other) const
+{
+    if (flags != other.flags || bindings.size() != other.bindings.size() || bindingFlags != other.bindingFlags)
+        return false;
+
+    for (size_t i = 0; i < bindings.size(); i++)
+    {
+        const VkDescriptorSetLayoutBinding &a = bindings[i];
+        const VkDescriptorSetLayoutBinding &b = other.bindings[i];
+
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount ||
+            a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers)
+            return false;
+    }
+
+    return true;
+}
+
+size_t DescriptorSetLayoutKeyHash::operator()(const DescriptorSetLayoutKey &key) const
+{
+    size_t seed = std::hash<uint32_t>()(key.flags);
+
+    for (const auto &binding : key.bindings)
+    {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, static_cast<size_t>(binding.descriptorType));
+        hashCombine(seed, binding.descriptorCount);
+        hashCombine(seed, binding.stageFlags);
+    }
+
+    for (auto bindingFlags : key.bindingFlags)
+        hashCombine(seed, bindingFlags);
+
+    return seed;
+}
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device, const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks)
+{
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+    for (auto &entry : layouts)
+        vkDestroyDescriptorSetLayout(device, entry.second, allocationCallbacks);
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings,
+                                                       std::vector<VkDescriptorBindingFlagsEXT> bindingFlags,
+                                                       VkDescriptorSetLayoutCreateFlags flags)
+{
+    if (!bindingFlags.empty() && bindingFlags.size() != bindings.size())
+        throw std::runtime_error("descriptor binding flags don't match bindings!");
+
+    // Binding flags follow their binding when sorting
+    std::vector<size_t> order(bindings.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&bindings](size_t a, size_t b)
+    {
+        return bindings[a].binding < bindings[b].binding;
+    });
+
+    DescriptorSetLayoutKey key;
+    key.flags = flags;
+    for (size_t index : order)
+    {
+        key.bindings.push_back(bindings[index]);
+        if (!bindingFlags.empty())
+            key.bindingFlags.push_back(bindingFlags[index]);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto existing = layouts.find(key);
+    if (existing != layouts.end())
+        return existing->second;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(key.bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = key.bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = key.bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+    layoutInfo.flags = flags;
+    layoutInfo.bindingCount = static_cast<uint32_t>(key.bindings.size());
+    layoutInfo.pBindings = key.bindings.data();
+
+    VkDescriptorSetLayout layout;
+
+    VkResult result = vkCreateDescriptorSetLayout(device, &layoutInfo, allocationCallbacks, &layout);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create descriptor set layout!");
+
+    layouts.emplace(std::move(key), layout);
+
+    return layout;
+}
+
+size_t DescriptorLayoutCache::getLayoutCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return layouts.size();
+}
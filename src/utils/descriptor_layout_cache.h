@@ -0,0 +1,58 @@
+#ifndef HELLO_VULKAN_DESCRIPTOR_LAYOUT_CACHE_H
+#define HELLO_VULKAN_DESCRIPTOR_LAYOUT_CACHE_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Everything that makes two descriptor set layouts different. Bindings are kept sorted by binding number,
+// so the same set declared in different order maps to one layout.
+struct DescriptorSetLayoutKey
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+    // Descriptor indexing flags, either empty or one per binding
+    std::vector<VkDescriptorBindingFlagsEXT> bindingFlags;
+
+    VkDescriptorSetLayoutCreateFlags flags = 0;
+
+    bool operator==(const DescriptorSetLayoutKey &other) const;
+};
+
+struct DescriptorSetLayoutKeyHash
+{
+    size_t operator()(const DescriptorSetLayoutKey &key) const;
+};
+
+// Owns every VkDescriptorSetLayout of the application. Identical binding lists always give the same handle,
+// which also makes pipeline layouts built from them compatible. Thread safe.
+class DescriptorLayoutCache
+{
+    public:
+
+        explicit DescriptorLayoutCache(VkDevice device, const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~DescriptorLayoutCache();
+
+        DescriptorLayoutCache(const DescriptorLayoutCache &) = delete;
+        DescriptorLayoutCache &operator=(const DescriptorLayoutCache &) = delete;
+
+        // Binding flags need VK_EXT_descriptor_indexing, pass empty vector without it
+        VkDescriptorSetLayout getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings,
+                                        std::vector<VkDescriptorBindingFlagsEXT> bindingFlags = {},
+                                        VkDescriptorSetLayoutCreateFlags flags = 0);
+
+        size_t getLayoutCount() const;
+
+    private:
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        mutable std::mutex mutex;
+        std::unordered_map<DescriptorSetLayoutKey, VkDescriptorSetLayout, DescriptorSetLayoutKeyHash> layouts;
+};
+
+#endif //HELLO_VULKAN_DESCRIPTOR_LAYOUT_CACHE_H
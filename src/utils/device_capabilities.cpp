@@ -0,0 +1,122 @@
+#include "device_capabilities.h"
+#include "cpu_profiler.h"
+
+#include <cstring>
+
+bool DeviceCapabilities::supportsExtension(const char *name) const
+{
+    for (const auto &extension : extensions)
+        if (strcmp(extension.extensionName, name) == 0)
+            return true;
+
+    return false;
+}
+
+const DeviceCapabilities &DeviceCapabilityCache::get(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface)
+{
+    auto found = snapshots.find(physicalDevice);
+
+    if (found == snapshots.end())
+    {
+        found = snapshots.emplace(physicalDevice, DeviceCapabilities{}).first;
+        queryDevice(physicalDevice, found->second);
+        querySurface(physicalDevice, surface, found->second);
+        return found->second;
+    }
+
+    if (found->second.surface != surface)
+    {
+        querySurface(physicalDevice, surface, found->second);
+        return found->second;
+    }
+
+    hitCount++;
+    return found->second;
+}
+
+void DeviceCapabilityCache::invalidateSurface()
+{
+    for (auto &snapshot : snapshots)
+    {
+        snapshot.second.surface = VK_NULL_HANDLE;
+        snapshot.second.presentSupport.clear();
+        snapshot.second.surfaceFormats.clear();
+        snapshot.second.presentModes.clear();
+    }
+}
+
+void DeviceCapabilityCache::queryDevice(VkPhysicalDevice physicalDevice, DeviceCapabilities &capabilities)
+{
+    CpuZone zone("query device capabilities");
+    queryCount++;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &capabilities.properties);
+    vkGetPhysicalDeviceFeatures(physicalDevice, &capabilities.features);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &capabilities.memoryProperties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    capabilities.queueFamilies.resize(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, capabilities.queueFamilies.data());
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    capabilities.extensions.resize(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, capabilities.extensions.data());
+
+    capabilities.hasUuid = capabilities.properties.apiVersion >= VK_API_VERSION_1_1;
+    if (capabilities.hasUuid)
+    {
+        VkPhysicalDeviceIDProperties idProperties{};
+        idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &idProperties;
+
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+        memcpy(capabilities.uuid, idProperties.deviceUUID, VK_UUID_SIZE);
+    }
+
+    if (capabilities.hasUuid && capabilities.supportsExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT &indexingFeatures = capabilities.descriptorIndexingFeatures;
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &indexingFeatures;
+
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+        indexingFeatures.pNext = nullptr;
+    }
+}
+
+void DeviceCapabilityCache::querySurface(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface,
+                                         DeviceCapabilities &capabilities)
+{
+    capabilities.surface = surface;
+    capabilities.presentSupport.assign(capabilities.queueFamilies.size(), VK_FALSE);
+    capabilities.surfaceFormats.clear();
+    capabilities.presentModes.clear();
+
+    if (surface == VK_NULL_HANDLE)
+        return;
+
+    CpuZone zone("query surface capabilities");
+    queryCount++;
+
+    for (uint32_t i = 0; i < capabilities.queueFamilies.size(); i++)
+        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &capabilities.presentSupport[i]);
+
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr);
+    capabilities.surfaceFormats.resize(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, capabilities.surfaceFormats.data());
+
+    uint32_t presentModeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, nullptr);
+    capabilities.presentModes.resize(presentModeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount,
+                                              capabilities.presentModes.data());
+}
@@ -0,0 +1,65 @@
+#ifndef HELLO_VULKAN_DEVICE_CAPABILITIES_H
+#define HELLO_VULKAN_DEVICE_CAPABILITIES_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Everything app asks physical device about, queried once. Surface capabilities are not part of it,
+// current extent changes with every resize and has to be queried fresh anyway.
+struct DeviceCapabilities
+{
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceFeatures features;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+    std::vector<VkExtensionProperties> extensions;
+
+    // Core since Vulkan 1.1, older devices don't report it
+    bool hasUuid = false;
+    uint8_t uuid[VK_UUID_SIZE];
+
+    // All false unless device is Vulkan 1.1 with VK_EXT_descriptor_indexing, pNext is always null
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+
+    // Filled for surface snapshot was taken with, empty without one
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    std::vector<VkBool32> presentSupport;
+    std::vector<VkSurfaceFormatKHR> surfaceFormats;
+    std::vector<VkPresentModeKHR> presentModes;
+
+    bool supportsExtension(const char *name) const;
+};
+
+// Per physical device snapshots. Device part never changes, surface part is re-queried when
+// snapshot is requested for another surface or after invalidateSurface().
+class DeviceCapabilityCache
+{
+    public:
+
+        const DeviceCapabilities &get(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
+
+        // Call when surface is recreated or destroyed, handle may be reused by driver
+        void invalidateSurface();
+
+        uint32_t getQueryCount() const
+        { return queryCount; }
+
+        uint32_t getHitCount() const
+        { return hitCount; }
+
+    private:
+
+        std::map<VkPhysicalDevice, DeviceCapabilities> snapshots;
+
+        uint32_t queryCount = 0;
+        uint32_t hitCount = 0;
+
+        void queryDevice(VkPhysicalDevice physicalDevice, DeviceCapabilities &capabilities);
+        void querySurface(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, DeviceCapabilities &capabilities);
+};
+
+#endif //HELLO_VULKAN_DEVICE_CAPABILITIES_H
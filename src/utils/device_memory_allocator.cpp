@@ -0,0 +1,412 @@
+#include "device_memory_allocator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+struct DeviceMemoryBlock
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    uint32_t memoryTypeIndex = 0;
+    bool linear = true;
+    void *mapped = nullptr;
+
+    // Offset -> size of every free range, neighbours are always merged
+    std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+    size_t allocationCount = 0;
+};
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return value / alignment * alignment;
+}
+
+DeviceMemoryAllocator::DeviceMemoryAllocator(const DeviceCapabilities &capabilities, VkDevice device,
+                                             VkDeviceSize preferredBlockSize,
+                                             const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks),
+        memoryProperties(capabilities.memoryProperties),
+        nonCoherentAtomSize(std::max<VkDeviceSize>(1, capabilities.properties.limits.nonCoherentAtomSize))
+{
+
+    // Small heaps (like 256 MiB host visible VRAM window) would be eaten by a couple of big blocks
+    blockSizes.resize(memoryProperties.memoryTypeCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[i].heapIndex].size;
+        blockSizes[i] = std::min(preferredBlockSize, std::max<VkDeviceSize>(heapSize / 8, 1024 * 1024));
+    }
+
+    stats.memoryTypes.resize(memoryProperties.memoryTypeCount);
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator()
+{
+    for (auto &block : blocks)
+        freeMemory(block->memory, block->mapped != nullptr);
+}
+
+uint32_t DeviceMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required,
+                                               VkMemoryPropertyFlags preferred) const
+{
+    VkMemoryPropertyFlags wanted[] = {required | preferred, required};
+
+    for (VkMemoryPropertyFlags properties : wanted)
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+                return i;
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+DeviceAllocation DeviceMemoryAllocator::allocate(const VkMemoryRequirements &requirements,
+                                                 VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+                                                 bool linear)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, required, preferred);
+    VkDeviceSize blockSize = blockSizes[memoryTypeIndex];
+
+    // Huge resources would waste most of a block anyway
+    if (requirements.size > blockSize / 2)
+        return allocateDedicated(requirements.size, memoryTypeIndex);
+
+    VkDeviceSize alignment = std::max<VkDeviceSize>(1, requirements.alignment);
+
+    // Flushing one allocation must never touch atoms of its neighbours
+    if (!(memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        alignment = std::max(alignment, nonCoherentAtomSize);
+
+    DeviceAllocation allocation;
+
+    for (auto &block : blocks)
+        if (block->memoryTypeIndex == memoryTypeIndex && block->linear == linear &&
+            allocateFromBlock(*block, requirements.size, alignment, allocation))
+            return allocation;
+
+    auto block = std::make_unique<DeviceMemoryBlock>();
+    block->memory = allocateMemory(blockSize, memoryTypeIndex, &block->mapped);
+    block->size = blockSize;
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->linear = linear;
+    block->freeRanges[0] = blockSize;
+
+    stats.memoryTypes[memoryTypeIndex].blockCount++;
+    stats.memoryTypes[memoryTypeIndex].reservedBytes += blockSize;
+
+    allocateFromBlock(*block, requirements.size, alignment, allocation);
+    blocks.push_back(std::move(block));
+
+    return allocation;
+}
+
+void DeviceMemoryAllocator::free(DeviceAllocation &allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    DeviceMemoryTypeStats &typeStats = stats.memoryTypes[allocation.memoryTypeIndex];
+    typeStats.allocationCount--;
+    typeStats.usedBytes -= allocation.size;
+
+    if (allocation.block == nullptr)
+    {
+        freeMemory(allocation.memory, allocation.mapped != nullptr);
+
+        typeStats.dedicatedCount--;
+        typeStats.reservedBytes -= allocation.size;
+
+        allocation = DeviceAllocation{};
+        return;
+    }
+
+    DeviceMemoryBlock &block = *allocation.block;
+    VkDeviceSize offset = allocation.offset;
+    VkDeviceSize size = allocation.size;
+
+    auto next = block.freeRanges.lower_bound(offset);
+    if (next != block.freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = block.freeRanges.erase(next);
+    }
+
+    if (next != block.freeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            block.freeRanges.erase(previous);
+        }
+    }
+
+    block.freeRanges[offset] = size;
+    block.allocationCount--;
+
+    // Keeping one empty block per kind avoids allocate/free ping-pong, any extra ones go back to driver
+    if (block.allocationCount == 0)
+    {
+        auto sameKind = [&block](const std::unique_ptr<DeviceMemoryBlock> &other)
+        {
+            return other.get() != &block && other->allocationCount == 0 &&
+                   other->memoryTypeIndex == block.memoryTypeIndex && other->linear == block.linear;
+        };
+
+        if (std::any_of(blocks.begin(), blocks.end(), sameKind))
+        {
+            freeMemory(block.memory, block.mapped != nullptr);
+
+            typeStats.blockCount--;
+            typeStats.reservedBytes -= block.size;
+
+            blocks.erase(std::find_if(blocks.begin(), blocks.end(),
+                                      [&block](const std::unique_ptr<DeviceMemoryBlock> &other)
+                                      { return other.get() == &block; }));
+        }
+    }
+
+    allocation = DeviceAllocation{};
+}
+
+VkBuffer DeviceMemoryAllocator::createBuffer(const VkBufferCreateInfo &bufferInfo, VkMemoryPropertyFlags required,
+                                             DeviceAllocation &allocation, VkMemoryPropertyFlags preferred)
+{
+    VkBuffer buffer;
+
+    VkResult result = vkCreateBuffer(device, &bufferInfo, allocationCallbacks, &buffer);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create buffer!");
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+    try
+    {
+        allocation = allocate(memRequirements, required, preferred, true);
+    }
+    catch (...)
+    {
+        vkDestroyBuffer(device, buffer, allocationCallbacks);
+        throw;
+    }
+
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+
+    return buffer;
+}
+
+VkImage DeviceMemoryAllocator::createImage(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags required,
+                                           DeviceAllocation &allocation, VkMemoryPropertyFlags preferred)
+{
+    VkImage image;
+
+    VkResult result = vkCreateImage(device, &imageInfo, allocationCallbacks, &image);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create image!");
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+    try
+    {
+        allocation = allocate(memRequirements, required, preferred, imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
+    }
+    catch (...)
+    {
+        vkDestroyImage(device, image, allocationCallbacks);
+        throw;
+    }
+
+    vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+
+    return image;
+}
+
+void DeviceMemoryAllocator::destroyBuffer(VkBuffer buffer, DeviceAllocation &allocation)
+{
+    vkDestroyBuffer(device, buffer, allocationCallbacks);
+    free(allocation);
+}
+
+void DeviceMemoryAllocator::destroyImage(VkImage image, DeviceAllocation &allocation)
+{
+    vkDestroyImage(device, image, allocationCallbacks);
+    free(allocation);
+}
+
+void DeviceMemoryAllocator::flush(const DeviceAllocation &allocation)
+{
+    if (memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        return;
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+
+    if (allocation.block == nullptr)
+    {
+        range.offset = 0;
+        range.size = VK_WHOLE_SIZE;
+    }
+    else
+    {
+        range.offset = alignDown(allocation.offset, nonCoherentAtomSize);
+        range.size = std::min(alignUp(allocation.offset + allocation.size, nonCoherentAtomSize),
+                              allocation.block->size) - range.offset;
+    }
+
+    vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+DeviceMemoryStats DeviceMemoryAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void DeviceMemoryAllocator::printStats(std::ostream &stream) const
+{
+    DeviceMemoryStats snapshot = getStats();
+    const double MIB = 1024.0 * 1024.0;
+
+    stream << "Device memory: " << snapshot.vkAllocateMemoryCalls << " vkAllocateMemory calls, "
+           << snapshot.vkFreeMemoryCalls << " vkFreeMemory calls" << std::endl;
+
+    for (size_t i = 0; i < snapshot.memoryTypes.size(); i++)
+    {
+        const DeviceMemoryTypeStats &typeStats = snapshot.memoryTypes[i];
+        if (typeStats.reservedBytes == 0)
+            continue;
+
+        stream << "\ttype " << i << " (heap " << memoryProperties.memoryTypes[i].heapIndex << ", flags 0x"
+               << std::hex << memoryProperties.memoryTypes[i].propertyFlags << std::dec << "): "
+               << typeStats.allocationCount << " allocations, " << std::fixed << std::setprecision(2)
+               << typeStats.usedBytes / MIB << " of " << typeStats.reservedBytes / MIB << " MiB used in "
+               << typeStats.blockCount << " blocks and " << typeStats.dedicatedCount << " dedicated allocations"
+               << std::defaultfloat << std::endl;
+    }
+}
+
+VkDeviceMemory DeviceMemoryAllocator::allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void **mapped)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory;
+
+    VkResult result = vkAllocateMemory(device, &allocInfo, allocationCallbacks, &memory);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate device memory!");
+
+    stats.vkAllocateMemoryCalls++;
+
+    // Mapping once for the whole lifetime is cheaper than map/unmap around every write
+    *mapped = nullptr;
+    if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+        if (result != VK_SUCCESS)
+        {
+            vkFreeMemory(device, memory, allocationCallbacks);
+            throw std::runtime_error("failed to map device memory!");
+        }
+    }
+
+    return memory;
+}
+
+void DeviceMemoryAllocator::freeMemory(VkDeviceMemory memory, bool mapped)
+{
+    if (mapped)
+        vkUnmapMemory(device, memory);
+
+    vkFreeMemory(device, memory, allocationCallbacks);
+    stats.vkFreeMemoryCalls++;
+}
+
+DeviceAllocation DeviceMemoryAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex)
+{
+    DeviceAllocation allocation;
+    allocation.memory = allocateMemory(size, memoryTypeIndex, &allocation.mapped);
+    allocation.offset = 0;
+    allocation.size = size;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.block = nullptr;
+
+    DeviceMemoryTypeStats &typeStats = stats.memoryTypes[memoryTypeIndex];
+    typeStats.dedicatedCount++;
+    typeStats.allocationCount++;
+    typeStats.reservedBytes += size;
+    typeStats.usedBytes += size;
+
+    return allocation;
+}
+
+bool DeviceMemoryAllocator::allocateFromBlock(DeviceMemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment,
+                                              DeviceAllocation &allocation)
+{
+    auto bestRange = block.freeRanges.end();
+    VkDeviceSize bestWaste = 0;
+
+    // Best fit keeps big holes intact for big resources
+    for (auto range = block.freeRanges.begin(); range != block.freeRanges.end(); ++range)
+    {
+        VkDeviceSize alignedOffset = alignUp(range->first, alignment);
+        VkDeviceSize padding = alignedOffset - range->first;
+
+        if (padding + size > range->second)
+            continue;
+
+        VkDeviceSize waste = range->second - padding - size;
+        if (bestRange == block.freeRanges.end() || waste < bestWaste)
+        {
+            bestRange = range;
+            bestWaste = waste;
+        }
+    }
+
+    if (bestRange == block.freeRanges.end())
+        return false;
+
+    VkDeviceSize rangeOffset = bestRange->first;
+    VkDeviceSize rangeSize = bestRange->second;
+    VkDeviceSize alignedOffset = alignUp(rangeOffset, alignment);
+    VkDeviceSize padding = alignedOffset - rangeOffset;
+
+    block.freeRanges.erase(bestRange);
+
+    if (padding > 0)
+        block.freeRanges[rangeOffset] = padding;
+
+    if (rangeSize > padding + size)
+        block.freeRanges[alignedOffset + size] = rangeSize - padding - size;
+
+    block.allocationCount++;
+
+    allocation.memory = block.memory;
+    allocation.offset = alignedOffset;
+    allocation.size = size;
+    allocation.mapped = block.mapped != nullptr ? static_cast<char *>(block.mapped) + alignedOffset : nullptr;
+    allocation.memoryTypeIndex = block.memoryTypeIndex;
+    allocation.block = &block;
+
+    DeviceMemoryTypeStats &typeStats = stats.memoryTypes[block.memoryTypeIndex];
+    typeStats.allocationCount++;
+    typeStats.usedBytes += size;
+
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef HELLO_VULKAN_DEVICE_MEMORY_ALLOCATOR_H
+#define HELLO_VULKAN_DEVICE_MEMORY_ALLOCATOR_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "device_capabilities.h"
+
+struct DeviceMemoryBlock;
+
+// Piece of device memory handed out by allocator. Memory and offset are what vkBind*Memory needs,
+// mapped is non-null for host visible memory, which stays persistently mapped.
+struct DeviceAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr;
+    uint32_t memoryTypeIndex = 0;
+
+    // Null for dedicated allocations, which own whole VkDeviceMemory
+    DeviceMemoryBlock *block = nullptr;
+};
+
+struct DeviceMemoryTypeStats
+{
+    size_t blockCount = 0;
+    size_t dedicatedCount = 0;
+    size_t allocationCount = 0;
+    VkDeviceSize reservedBytes = 0;  // everything taken from driver
+    VkDeviceSize usedBytes = 0;      // everything handed out to resources
+};
+
+struct DeviceMemoryStats
+{
+    std::vector<DeviceMemoryTypeStats> memoryTypes;
+    uint64_t vkAllocateMemoryCalls = 0;
+    uint64_t vkFreeMemoryCalls = 0;
+};
+
+// Sub-allocates buffers and images from big per memory type blocks instead of calling vkAllocateMemory for each
+// resource, which is slow and limited by maxMemoryAllocationCount. Each block keeps sorted free list with
+// best fit placement and coalescing on free. Linear resources (buffers) and optimal tiling images never share
+// a block, so bufferImageGranularity can't be violated. Thread safe.
+class DeviceMemoryAllocator
+{
+    public:
+
+        static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+        DeviceMemoryAllocator(const DeviceCapabilities &capabilities, VkDevice device,
+                              VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE,
+                              const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~DeviceMemoryAllocator();
+
+        DeviceMemoryAllocator(const DeviceMemoryAllocator &) = delete;
+        DeviceMemoryAllocator &operator=(const DeviceMemoryAllocator &) = delete;
+
+        // Memory type having all required and, when possible, all preferred property flags
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required,
+                                VkMemoryPropertyFlags preferred = 0) const;
+
+        DeviceAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags required,
+                                  VkMemoryPropertyFlags preferred, bool linear);
+        void free(DeviceAllocation &allocation);
+
+        // Create resource, allocate memory for it and bind it
+        VkBuffer createBuffer(const VkBufferCreateInfo &bufferInfo, VkMemoryPropertyFlags required,
+                              DeviceAllocation &allocation, VkMemoryPropertyFlags preferred = 0);
+        VkImage createImage(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags required,
+                            DeviceAllocation &allocation, VkMemoryPropertyFlags preferred = 0);
+
+        void destroyBuffer(VkBuffer buffer, DeviceAllocation &allocation);
+        void destroyImage(VkImage image, DeviceAllocation &allocation);
+
+        // Needed for non-coherent host visible memory after CPU writes
+        void flush(const DeviceAllocation &allocation);
+
+        DeviceMemoryStats getStats() const;
+        void printStats(std::ostream &stream) const;
+
+    private:
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        VkDeviceSize nonCoherentAtomSize;
+        std::vector<VkDeviceSize> blockSizes;  // per memory type
+
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<DeviceMemoryBlock>> blocks;
+        DeviceMemoryStats stats;
+
+        VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void **mapped);
+        void freeMemory(VkDeviceMemory memory, bool mapped);
+
+        DeviceAllocation allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex);
+        bool allocateFromBlock(DeviceMemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment,
+                               DeviceAllocation &allocation);
+};
+
+#endif //HELLO_VULKAN_DEVICE_MEMORY_ALLOCATOR_H
@@ -0,0 +1,64 @@
+#include "device_selector.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+static std::string toLower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string formatUuid(const uint8_t uuid[VK_UUID_SIZE])
+{
+    std::stringstream stream;
+    stream << std::hex << std::setfill('0');
+
+    for (size_t i = 0; i < VK_UUID_SIZE; i++)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+            stream << '-';
+        stream << std::setw(2) << static_cast<uint32_t>(uuid[i]);
+    }
+
+    return stream.str();
+}
+
+const char *deviceTypeName(VkPhysicalDeviceType type)
+{
+    switch (type)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            return "discrete";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            return "integrated";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            return "virtual";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            return "cpu";
+        default:
+            return "other";
+    }
+}
+
+bool matchesDeviceSelector(const std::string &selector, const char *deviceName, const uint8_t *deviceUuid)
+{
+    std::string normalizedSelector = toLower(selector);
+
+    if (deviceUuid != nullptr)
+    {
+        std::string uuid = formatUuid(deviceUuid);
+        uuid.erase(std::remove(uuid.begin(), uuid.end(), '-'), uuid.end());
+
+        std::string selectorDigits = normalizedSelector;
+        selectorDigits.erase(std::remove(selectorDigits.begin(), selectorDigits.end(), '-'), selectorDigits.end());
+
+        if (selectorDigits == uuid)
+            return true;
+    }
+
+    return toLower(deviceName).find(normalizedSelector) != std::string::npos;
+}
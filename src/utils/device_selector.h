@@ -0,0 +1,18 @@
+#ifndef HELLO_VULKAN_DEVICE_SELECTOR_H
+#define HELLO_VULKAN_DEVICE_SELECTOR_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+
+// Canonical 8-4-4-4-12 form, the way vulkaninfo prints it
+std::string formatUuid(const uint8_t uuid[VK_UUID_SIZE]);
+
+const char *deviceTypeName(VkPhysicalDeviceType type);
+
+// Selector is either device UUID (dashes and case don't matter) or case-insensitive part of device name.
+// Device UUID is unknown for Vulkan 1.0 devices, pass nullptr then.
+bool matchesDeviceSelector(const std::string &selector, const char *deviceName, const uint8_t *deviceUuid);
+
+#endif //HELLO_VULKAN_DEVICE_SELECTOR_H
@@ -0,0 +1,10 @@
+#include "embedded_shaders.h"
+
+size_t getEmbeddedShaderCount()
+{
+    size_t count = 0;
+    while (EMBEDDED_SHADERS[count].name != nullptr)
+        count++;
+
+    return count;
+}
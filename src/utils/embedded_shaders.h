@@ -0,0 +1,23 @@
+#ifndef HELLO_VULKAN_EMBEDDED_SHADERS_H
+#define HELLO_VULKAN_EMBEDDED_SHADERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// SPIR-V compiled into the binary at build time, looked up by the name its file would have, e.g. "vert.spv"
+struct EmbeddedShader
+{
+    const char *name;
+    const uint32_t *code;
+
+    // In bytes, as VkShaderModuleCreateInfo::codeSize expects
+    size_t size;
+};
+
+// Terminated by entry with null name. Defined in source generated by cmake/embed_spirv.cmake, which holds only
+// the terminator when build had no glslc.
+extern const EmbeddedShader EMBEDDED_SHADERS[];
+
+size_t getEmbeddedShaderCount();
+
+#endif //HELLO_VULKAN_EMBEDDED_SHADERS_H
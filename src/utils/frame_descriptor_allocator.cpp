@@ -0,0 +1,111 @@
+#include "frame_descriptor_allocator.h"
+
+#include <stdexcept>
+
+// Descriptors of each type per set, roughly what a material with a few buffers and textures needs
+static const VkDescriptorPoolSize POOL_SIZE_RATIOS[] =
+        {
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2},
+                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2},
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4},
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}
+        };
+
+FrameDescriptorAllocator::FrameDescriptorAllocator(VkDevice device, uint32_t framesInFlight, uint32_t setsPerPool,
+                                                   const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        setsPerPool(setsPerPool),
+        allocationCallbacks(allocationCallbacks),
+        frames(framesInFlight)
+{
+}
+
+FrameDescriptorAllocator::~FrameDescriptorAllocator()
+{
+    for (auto &frame : frames)
+        for (auto pool : frame.pools)
+            vkDestroyDescriptorPool(device, pool, allocationCallbacks);
+}
+
+void FrameDescriptorAllocator::beginFrame(uint32_t frame)
+{
+    currentFrame = frame;
+    frameSetCount = 0;
+
+    FramePools &framePools = frames[frame];
+
+    // Pools past the active one were never touched since last reset
+    for (size_t i = 0; i <= framePools.activePool && i < framePools.pools.size(); i++)
+        vkResetDescriptorPool(device, framePools.pools[i], 0);
+
+    framePools.activePool = 0;
+    framePools.activePoolSetCount = 0;
+}
+
+VkDescriptorSet FrameDescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+{
+    FramePools &framePools = frames[currentFrame];
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    // Fresh pool failing means the layout can never fit, no point in trying more than one
+    while (true)
+    {
+        if (framePools.activePool == framePools.pools.size())
+            framePools.pools.push_back(createPool());
+
+        allocInfo.descriptorPool = framePools.pools[framePools.activePool];
+
+        VkDescriptorSet set;
+        VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+        if (result == VK_SUCCESS)
+        {
+            framePools.activePoolSetCount++;
+            frameSetCount++;
+            return set;
+        }
+
+        bool poolExhausted = result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL;
+        if (!poolExhausted || framePools.activePoolSetCount == 0)
+            throw std::runtime_error("failed to allocate descriptor set!");
+
+        framePools.activePool++;
+        framePools.activePoolSetCount = 0;
+    }
+}
+
+size_t FrameDescriptorAllocator::getPoolCount() const
+{
+    size_t poolCount = 0;
+    for (const auto &frame : frames)
+        poolCount += frame.pools.size();
+
+    return poolCount;
+}
+
+VkDescriptorPool FrameDescriptorAllocator::createPool()
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const auto &ratio : POOL_SIZE_RATIOS)
+        poolSizes.push_back({ratio.type, ratio.descriptorCount * setsPerPool});
+
+    // No FREE_DESCRIPTOR_SET_BIT, sets only go away with the whole pool, which lets driver use linear allocation
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = 0;
+    poolInfo.maxSets = setsPerPool;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool pool;
+
+    VkResult result = vkCreateDescriptorPool(device, &poolInfo, allocationCallbacks, &pool);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create descriptor pool!");
+
+    return pool;
+}
@@ -0,0 +1,58 @@
+#ifndef HELLO_VULKAN_FRAME_DESCRIPTOR_ALLOCATOR_H
+#define HELLO_VULKAN_FRAME_DESCRIPTOR_ALLOCATOR_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+// Descriptor sets which live for one frame. Every frame in flight has its own list of pools, sets are never freed
+// one by one: once the frame's fence is signaled, beginFrame() resets all its pools with one call each.
+// When a pool runs out, next one is taken, or created, so pool sizes are a hint and not a limit.
+// Not thread safe, allocate sets on the thread driving the frame and hand them to recording threads.
+class FrameDescriptorAllocator
+{
+    public:
+
+        static const uint32_t DEFAULT_SETS_PER_POOL = 64;
+
+        FrameDescriptorAllocator(VkDevice device, uint32_t framesInFlight,
+                                 uint32_t setsPerPool = DEFAULT_SETS_PER_POOL,
+                                 const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~FrameDescriptorAllocator();
+
+        FrameDescriptorAllocator(const FrameDescriptorAllocator &) = delete;
+        FrameDescriptorAllocator &operator=(const FrameDescriptorAllocator &) = delete;
+
+        // Sets allocated the last time this frame slot was used must no longer be in use by GPU
+        void beginFrame(uint32_t frame);
+
+        VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+        size_t getPoolCount() const;
+
+        // Allocations since last beginFrame()
+        uint32_t getFrameSetCount() const
+        { return frameSetCount; }
+
+    private:
+
+        struct FramePools
+        {
+            std::vector<VkDescriptorPool> pools;
+            size_t activePool = 0;
+            uint32_t activePoolSetCount = 0;
+        };
+
+        VkDevice device;
+        uint32_t setsPerPool;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        std::vector<FramePools> frames;
+        uint32_t currentFrame = 0;
+        uint32_t frameSetCount = 0;
+
+        VkDescriptorPool createPool();
+};
+
+#endif //HELLO_VULKAN_FRAME_DESCRIPTOR_ALLOCATOR_H
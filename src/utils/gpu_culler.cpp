@@ -0,0 +1,192 @@
+#include "gpu_culler.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Matches push constant block of cull.comp
+struct CullPushConstants
+{
+    uint32_t objectCount;
+    uint32_t indexCount;
+    float meshRadius;
+};
+
+// Constant ids of cull.comp
+static const uint32_t WORKGROUP_SIZE_CONSTANT = 0;
+static const uint32_t COMPACT_CONSTANT = 1;
+static const uint32_t PLANE_COUNT_CONSTANT = 2;
+
+// Left, right, bottom and top, 2D scene has no near and far planes
+static const int32_t FRUSTUM_PLANE_COUNT = 4;
+
+// Draw count and padding ahead of commands, keeps commands 16 byte aligned
+static const VkDeviceSize COMMANDS_OFFSET = 4 * sizeof(uint32_t);
+
+GpuCuller::GpuCuller(VkDevice device, DeviceMemoryAllocator &allocator, DescriptorLayoutCache &layoutCache,
+                     PipelineRegistry &pipelineRegistry, uint32_t framesInFlight, uint32_t objectCount,
+                     uint32_t indexCount, float meshRadius,
+                     PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount,
+                     const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocator(allocator),
+        allocationCallbacks(allocationCallbacks),
+        objectCount(objectCount),
+        indexCount(indexCount),
+        meshRadius(meshRadius),
+        drawIndexedIndirectCount(drawIndexedIndirectCount),
+        descriptorSets(framesInFlight, VK_NULL_HANDLE)
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    setLayout = layoutCache.getLayout(bindings);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocationCallbacks, &pipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create culling pipeline layout!");
+
+    ComputePipelineDescription description;
+    description.shader = "cull.spv";
+    description.constants.set(WORKGROUP_SIZE_CONSTANT, WORKGROUP_SIZE)
+            .set(COMPACT_CONSTANT, usesDrawIndirectCount())
+            .set(PLANE_COUNT_CONSTANT, FRUSTUM_PLANE_COUNT);
+    description.layout = pipelineLayout;
+
+    try
+    {
+        pipeline = pipelineRegistry.get(description);
+    }
+    catch (...)
+    {
+        vkDestroyPipelineLayout(device, pipelineLayout, allocationCallbacks);
+        throw;
+    }
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = COMMANDS_OFFSET + sizeof(VkDrawIndexedIndirectCommand) * objectCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    outputBuffers.resize(framesInFlight);
+    outputMemory.resize(framesInFlight);
+
+    for (uint32_t i = 0; i < framesInFlight; i++)
+        outputBuffers[i] = allocator.createBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outputMemory[i]);
+}
+
+GpuCuller::~GpuCuller()
+{
+    for (size_t i = 0; i < outputBuffers.size(); i++)
+        allocator.destroyBuffer(outputBuffers[i], outputMemory[i]);
+
+    vkDestroyPipelineLayout(device, pipelineLayout, allocationCallbacks);
+}
+
+bool GpuCuller::isSupported(const DeviceCapabilities &capabilities)
+{
+    return capabilities.features.drawIndirectFirstInstance;
+}
+
+void GpuCuller::updateDescriptors(uint32_t frame, FrameDescriptorAllocator &descriptorAllocator,
+                                  VkBuffer frameUniforms, VkDeviceSize frameUniformsSize, VkBuffer objects)
+{
+    descriptorSets[frame] = descriptorAllocator.allocate(setLayout);
+
+    VkDescriptorBufferInfo bufferInfos[3] =
+            {
+                    {frameUniforms, 0, frameUniformsSize},
+                    {objects, 0, VK_WHOLE_SIZE},
+                    {outputBuffers[frame], 0, VK_WHOLE_SIZE}
+            };
+
+    VkWriteDescriptorSet writes[3]{};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSets[frame];
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+}
+
+void GpuCuller::recordCulling(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    VkBuffer output = outputBuffers[frame];
+
+    vkCmdFillBuffer(commandBuffer, output, 0, sizeof(uint32_t), 0);
+
+    VkBufferMemoryBarrier resetBarrier{};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.buffer = output;
+    resetBarrier.offset = 0;
+    resetBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 1, &resetBarrier, 0, nullptr);
+
+    CullPushConstants pushConstants{};
+    pushConstants.objectCount = objectCount;
+    pushConstants.indexCount = indexCount;
+    pushConstants.meshRadius = meshRadius;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &descriptorSets[frame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants),
+                       &pushConstants);
+    vkCmdDispatch(commandBuffer, (objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    VkBufferMemoryBarrier drawBarrier = resetBarrier;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                         0, nullptr, 1, &drawBarrier, 0, nullptr);
+}
+
+void GpuCuller::recordDraws(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t maxDrawsPerCall) const
+{
+    VkBuffer output = outputBuffers[frame];
+    auto stride = static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+
+    if (drawIndexedIndirectCount != nullptr)
+    {
+        drawIndexedIndirectCount(commandBuffer, output, COMMANDS_OFFSET, output, 0, objectCount, stride);
+        return;
+    }
+
+    maxDrawsPerCall = std::max(maxDrawsPerCall, 1u);
+    for (uint32_t first = 0; first < objectCount; first += maxDrawsPerCall)
+    {
+        uint32_t count = std::min(maxDrawsPerCall, objectCount - first);
+        vkCmdDrawIndexedIndirect(commandBuffer, output, COMMANDS_OFFSET + first * stride, count, stride);
+    }
+}
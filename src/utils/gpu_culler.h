@@ -0,0 +1,79 @@
+#ifndef HELLO_VULKAN_GPU_CULLER_H
+#define HELLO_VULKAN_GPU_CULLER_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+#include "descriptor_layout_cache.h"
+#include "device_capabilities.h"
+#include "device_memory_allocator.h"
+#include "frame_descriptor_allocator.h"
+#include "pipeline_registry.h"
+
+// Frustum culling in a compute pass. Every frame, one thread per object tests the object's bounding sphere
+// against frustum planes from frame uniforms and appends an indirect draw for each survivor, so CPU never looks
+// at individual objects. Output has per frame in flight buffer laid out as
+//
+//   uint drawCount; uint padding[3]; VkDrawIndexedIndirectCommand commands[objectCount];
+//
+// With drawIndirectCount the graphics pass consumes exactly drawCount compacted commands. Without it every
+// object keeps its own slot and culled ones get zero instances, GPU still skips them cheaply.
+class GpuCuller
+{
+    public:
+
+        static const uint32_t WORKGROUP_SIZE = 64;
+
+        // Frame uniforms at binding 0, object buffer of Instance structs at binding 1, output at binding 2.
+        // drawIndexedIndirectCount can only be non-null when device has VK_KHR_draw_indirect_count enabled, it picks
+        // compacting variant of the shader, so it's fixed for culler's lifetime.
+        GpuCuller(VkDevice device, DeviceMemoryAllocator &allocator, DescriptorLayoutCache &layoutCache,
+                  PipelineRegistry &pipelineRegistry, uint32_t framesInFlight, uint32_t objectCount,
+                  uint32_t indexCount, float meshRadius,
+                  PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr,
+                  const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~GpuCuller();
+
+        GpuCuller(const GpuCuller &) = delete;
+        GpuCuller &operator=(const GpuCuller &) = delete;
+
+        // Survivors reference their object through firstInstance
+        static bool isSupported(const DeviceCapabilities &capabilities);
+
+        bool usesDrawIndirectCount() const
+        { return drawIndexedIndirectCount != nullptr; }
+
+        // Once per frame before recording, descriptor set comes from the frame's pools
+        void updateDescriptors(uint32_t frame, FrameDescriptorAllocator &descriptorAllocator,
+                               VkBuffer frameUniforms, VkDeviceSize frameUniformsSize, VkBuffer objects);
+
+        // Has to be recorded outside of render pass, leaves output ready for indirect reads
+        void recordCulling(VkCommandBuffer commandBuffer, uint32_t frame);
+
+        // Inside render pass, maxDrawsPerCall only matters without drawIndirectCount
+        void recordDraws(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t maxDrawsPerCall) const;
+
+    private:
+
+        VkDevice device;
+        DeviceMemoryAllocator &allocator;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        uint32_t objectCount;
+        uint32_t indexCount;
+        float meshRadius;
+
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount;
+
+        VkDescriptorSetLayout setLayout;
+        VkPipelineLayout pipelineLayout;
+        VkPipeline pipeline;  // owned by registry
+
+        std::vector<VkBuffer> outputBuffers;
+        std::vector<DeviceAllocation> outputMemory;
+        std::vector<VkDescriptorSet> descriptorSets;
+};
+
+#endif //HELLO_VULKAN_GPU_CULLER_H
@@ -0,0 +1,226 @@
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+
+GpuProfiler::GpuProfiler(const DeviceCapabilities &capabilities, VkDevice device, uint32_t queueFamily,
+                         uint32_t framesInFlight, uint32_t maxScopesPerFrame,
+                         const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks),
+        maxScopesPerFrame(maxScopesPerFrame),
+        frameQueries(framesInFlight)
+{
+    uint32_t validBits = capabilities.queueFamilies[queueFamily].timestampValidBits;
+
+    // Nanoseconds per tick
+    timestampPeriod = capabilities.properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+    // Without valid bits queue doesn't support timestamps at all, profiler does nothing then
+    if (validBits == 0)
+        return;
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = framesInFlight * maxScopesPerFrame * 2;
+
+    if (vkCreateQueryPool(device, &poolInfo, allocationCallbacks, &queryPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create timestamp query pool!");
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if (queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device, queryPool, allocationCallbacks);
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (!isSupported())
+        return;
+
+    resolve(frame);
+
+    currentFrame = frame;
+    currentDepth = 0;
+
+    frameQueries[frame].frameNumber = frameCounter++;
+    frameQueries[frame].scopes.clear();
+
+    vkCmdResetQueryPool(commandBuffer, queryPool, frame * maxScopesPerFrame * 2, maxScopesPerFrame * 2);
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string &name)
+{
+    if (!isSupported())
+        return UINT32_MAX;
+
+    auto &scopes = frameQueries[currentFrame].scopes;
+    if (scopes.size() >= maxScopesPerFrame)
+        return UINT32_MAX;
+
+    auto scope = static_cast<uint32_t>(scopes.size());
+    scopes.push_back({name, currentDepth, false});
+    currentDepth++;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool,
+                        (currentFrame * maxScopesPerFrame + scope) * 2);
+
+    return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+    if (scope == UINT32_MAX)
+        return;
+
+    frameQueries[currentFrame].scopes[scope].ended = true;
+    currentDepth--;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool,
+                        (currentFrame * maxScopesPerFrame + scope) * 2 + 1);
+}
+
+void GpuProfiler::resolveAll()
+{
+    for (uint32_t frame = 0; frame < frameQueries.size(); frame++)
+        resolve(frame);
+
+    // Frames in flight are not resolved in order they were recorded
+    std::stable_sort(frames.begin(), frames.end(), [](const FrameTiming &a, const FrameTiming &b)
+    {
+        return a.frameNumber < b.frameNumber;
+    });
+}
+
+void GpuProfiler::resolve(uint32_t frame)
+{
+    auto &queries = frameQueries[frame];
+    if (queries.scopes.empty())
+        return;
+
+    auto queryCount = static_cast<uint32_t>(queries.scopes.size() * 2);
+    std::vector<uint64_t> timestamps(queryCount);
+
+    // No WAIT_BIT: frame's fence was already waited on, and if some query still isn't ready, frame is dropped
+    VkResult result = vkGetQueryPoolResults(device, queryPool, frame * maxScopesPerFrame * 2, queryCount,
+                                            timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+    if (result == VK_SUCCESS)
+    {
+        if (!hasBaseTimestamp)
+        {
+            baseTimestamp = timestamps[0] & timestampMask;
+            hasBaseTimestamp = true;
+        }
+
+        FrameTiming timing;
+        timing.frameNumber = queries.frameNumber;
+
+        for (size_t i = 0; i < queries.scopes.size(); i++)
+        {
+            if (!queries.scopes[i].ended)
+                continue;
+
+            uint64_t start = timestamps[i * 2] & timestampMask;
+            uint64_t end = timestamps[i * 2 + 1] & timestampMask;
+
+            ScopeTiming scope;
+            scope.name = queries.scopes[i].name;
+            scope.depth = queries.scopes[i].depth;
+            scope.start = double(start - baseTimestamp) * timestampPeriod / 1e6;
+            scope.duration = double((end - start) & timestampMask) * timestampPeriod / 1e6;
+            timing.scopes.push_back(scope);
+        }
+
+        frames.push_back(std::move(timing));
+    }
+
+    queries.scopes.clear();
+}
+
+void GpuProfiler::printSummary(std::ostream &out) const
+{
+    if (frames.empty())
+        return;
+
+    // Keep order of first appearance, so nested scopes are printed under their parents
+    std::vector<std::string> order;
+    std::map<std::string, std::pair<double, uint32_t>> totals;
+
+    for (const auto &frame : frames)
+    {
+        for (const auto &scope : frame.scopes)
+        {
+            std::string label = std::string(scope.depth * 2, ' ') + scope.name;
+
+            auto &total = totals[label];
+            if (total.second == 0)
+                order.push_back(label);
+
+            total.first += scope.duration;
+            total.second++;
+        }
+    }
+
+    out << "GPU time over " << frames.size() << " frames:" << std::endl;
+    for (const auto &label : order)
+        out << "  " << label << ": " << totals[label].first / totals[label].second << " ms" << std::endl;
+}
+
+void GpuProfiler::exportToFile(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open " + filename + " for GPU profile!");
+
+    const std::string csvExtension = ".csv";
+    bool csv = filename.size() >= csvExtension.size() &&
+               filename.compare(filename.size() - csvExtension.size(), csvExtension.size(), csvExtension) == 0;
+
+    if (csv)
+        writeCsv(file);
+    else
+        writeChromeTrace(file);
+}
+
+void GpuProfiler::writeCsv(std::ostream &out) const
+{
+    out << std::fixed << std::setprecision(6);
+    out << "frame,scope,depth,start_ms,duration_ms\n";
+
+    for (const auto &frame : frames)
+        for (const auto &scope : frame.scopes)
+            out << frame.frameNumber << "," << scope.name << "," << scope.depth << ","
+                << scope.start << "," << scope.duration << "\n";
+}
+
+void GpuProfiler::writeChromeTrace(std::ostream &out) const
+{
+    // Complete events ("ph": "X"), times in microseconds
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto &frame : frames)
+    {
+        for (const auto &scope : frame.scopes)
+        {
+            if (!first)
+                out << ",";
+            first = false;
+
+            out << "\n{\"name\":\"" << scope.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":\"GPU\""
+                << ",\"ts\":" << scope.start * 1000.0 << ",\"dur\":" << scope.duration * 1000.0
+                << ",\"args\":{\"frame\":" << frame.frameNumber << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+}
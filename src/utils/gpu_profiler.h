@@ -0,0 +1,105 @@
+#ifndef HELLO_VULKAN_GPU_PROFILER_H
+#define HELLO_VULKAN_GPU_PROFILER_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "device_capabilities.h"
+
+// Measures GPU time of named scopes with timestamp queries. Every frame in flight owns its own range
+// of query pool, which is read back only after that frame's fence was waited on, so reading never stalls.
+// Scopes may nest, but have to be recorded into primary command buffers on one thread.
+class GpuProfiler
+{
+    public:
+
+        struct ScopeTiming
+        {
+            std::string name;
+            uint32_t depth;
+
+            // Milliseconds, start is relative to the first timestamp ever resolved
+            double start;
+            double duration;
+        };
+
+        struct FrameTiming
+        {
+            uint64_t frameNumber;
+            std::vector<ScopeTiming> scopes;
+        };
+
+        // Timestamps have to be supported by queue family command buffers are submitted to
+        GpuProfiler(const DeviceCapabilities &capabilities, VkDevice device, uint32_t queueFamily,
+                    uint32_t framesInFlight, uint32_t maxScopesPerFrame = 64,
+                    const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler &) = delete;
+        GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+        // Must be recorded outside of render pass, after previous submission of this frame has finished
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+        // Returns scope index for endScope(), scopes over per-frame limit are silently skipped
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const std::string &name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+        // Reads back every frame still pending, device must be idle
+        void resolveAll();
+
+        bool isSupported() const
+        { return queryPool != VK_NULL_HANDLE; }
+
+        const std::vector<FrameTiming> &getFrames() const
+        { return frames; }
+
+        // Average duration of each scope over all resolved frames
+        void printSummary(std::ostream &out) const;
+
+        // Format is picked by extension: .csv or Chrome trace JSON (chrome://tracing, Perfetto) otherwise
+        void exportToFile(const std::string &filename) const;
+
+    private:
+
+        struct PendingScope
+        {
+            std::string name;
+            uint32_t depth;
+            bool ended;
+        };
+
+        struct FrameQueries
+        {
+            uint64_t frameNumber = 0;
+            std::vector<PendingScope> scopes;
+        };
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+
+        double timestampPeriod;
+        uint64_t timestampMask;
+        uint32_t maxScopesPerFrame;
+
+        std::vector<FrameQueries> frameQueries;
+        uint32_t currentFrame = 0;
+        uint32_t currentDepth = 0;
+        uint64_t frameCounter = 0;
+
+        bool hasBaseTimestamp = false;
+        uint64_t baseTimestamp = 0;
+
+        std::vector<FrameTiming> frames;
+
+        void resolve(uint32_t frame);
+        void writeCsv(std::ostream &out) const;
+        void writeChromeTrace(std::ostream &out) const;
+};
+
+#endif //HELLO_VULKAN_GPU_PROFILER_H
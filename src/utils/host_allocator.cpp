@@ -0,0 +1,380 @@
+#include "host_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+static void *alignedAlloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants size to be a multiple of alignment
+    size = (size + alignment - 1) & ~(alignment - 1);
+    return std::aligned_alloc(alignment, size);
+#endif
+}
+
+static void alignedFree(void *memory)
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+static size_t sizeClassOf(size_t size)
+{
+    size_t sizeClass = 0;
+    size_t blockSize = HostAllocator::MIN_BLOCK_SIZE;
+
+    while (blockSize < size)
+    {
+        blockSize <<= 1;
+        sizeClass++;
+    }
+
+    return sizeClass;
+}
+
+static size_t scopeIndex(VkSystemAllocationScope scope)
+{
+    return std::min(static_cast<size_t>(scope), static_cast<size_t>(VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE));
+}
+
+static const char *scopeName(size_t scope)
+{
+    switch (scope)
+    {
+        case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+            return "command";
+        case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+            return "object";
+        case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+            return "cache";
+        case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+            return "device";
+        default:
+            return "instance";
+    }
+}
+
+HostAllocator::HostAllocator()
+{
+    callbacks.pUserData = this;
+    callbacks.pfnAllocation = allocationCallback;
+    callbacks.pfnReallocation = reallocationCallback;
+    callbacks.pfnFree = freeCallback;
+    callbacks.pfnInternalAllocation = internalAllocationCallback;
+    callbacks.pfnInternalFree = internalFreeCallback;
+}
+
+HostAllocator::~HostAllocator()
+{
+    // Anything still live was leaked by its owner, nobody can free it after this point anyway
+    for (auto &allocation : live)
+        if (allocation.second.source == Source::System)
+            alignedFree(allocation.first);
+
+    for (auto slab : slabs)
+        alignedFree(slab);
+
+    for (auto &chunk : arenaChunks)
+        alignedFree(chunk.memory);
+}
+
+HostAllocationScopeStats HostAllocator::getScopeStats(VkSystemAllocationScope scope) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return scopeStats[scopeIndex(scope)];
+}
+
+void HostAllocator::printStats(std::ostream &out) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    out << "Host allocations by scope:" << std::endl;
+    out << "  " << std::left << std::setw(10) << "scope" << std::right
+        << std::setw(10) << "allocs" << std::setw(10) << "reallocs" << std::setw(10) << "frees"
+        << std::setw(8) << "live" << std::setw(12) << "live KiB" << std::setw(12) << "peak KiB"
+        << std::setw(14) << "internal KiB" << std::endl;
+
+    for (size_t scope = 0; scope < SCOPE_COUNT; scope++)
+    {
+        const HostAllocationScopeStats &stats = scopeStats[scope];
+
+        out << "  " << std::left << std::setw(10) << scopeName(scope) << std::right
+            << std::setw(10) << stats.allocations << std::setw(10) << stats.reallocations
+            << std::setw(10) << stats.frees << std::setw(8) << stats.liveCount
+            << std::setw(12) << stats.liveBytes / 1024 << std::setw(12) << stats.peakBytes / 1024
+            << std::setw(14) << stats.internalBytes / 1024 << std::endl;
+    }
+
+    out << "  footprint: " << slabs.size() << " slabs (" << slabs.size() * SLAB_SIZE / 1024 << " KiB), "
+        << arenaChunks.size() << " arena chunks (" << arenaChunks.size() * ARENA_CHUNK_SIZE / 1024 << " KiB), "
+        << systemBytes / 1024 << " KiB from system allocator" << std::endl;
+}
+
+void *HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    if (size == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    void *memory = allocateLocked(size, alignment, scope);
+    if (memory != nullptr)
+        scopeStats[scopeIndex(scope)].allocations++;
+
+    return memory;
+}
+
+void *HostAllocator::reallocate(void *original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    if (original == nullptr)
+        return allocate(size, alignment, scope);
+
+    if (size == 0)
+    {
+        free(original);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto existing = live.find(original);
+    if (existing == live.end())
+        return nullptr;
+
+    Allocation &allocation = existing->second;
+    HostAllocationScopeStats &stats = scopeStats[scopeIndex(allocation.scope)];
+    stats.reallocations++;
+
+    // Shrinking or growing within rounded up block needs no copy
+    if (size <= allocation.capacity && alignment <= allocation.alignment)
+    {
+        stats.liveBytes = stats.liveBytes - allocation.size + size;
+        stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+        allocation.size = size;
+        return original;
+    }
+
+    size_t oldSize = allocation.size;
+
+    // Block stays accounted under the scope it was first allocated with, whatever scope driver passes here,
+    // so freeLocked() below subtracts from the same stats the new block is added to
+    void *memory = allocateLocked(size, alignment, allocation.scope);
+    if (memory == nullptr)
+        return nullptr;
+
+    std::memcpy(memory, original, std::min(oldSize, size));
+    freeLocked(original);
+
+    return memory;
+}
+
+void HostAllocator::free(void *memory)
+{
+    if (memory == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto existing = live.find(memory);
+    if (existing == live.end())
+        return;
+
+    scopeStats[scopeIndex(existing->second.scope)].frees++;
+    freeLocked(memory);
+}
+
+void *HostAllocator::allocateLocked(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+
+    Allocation allocation{};
+    allocation.size = size;
+    allocation.alignment = alignment;
+    allocation.scope = scope;
+
+    void *memory = nullptr;
+
+    if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND && alignment <= MAX_BLOCK_SIZE && size <= ARENA_CHUNK_SIZE / 4)
+    {
+        memory = allocateFromArena(size, alignment, allocation.arenaChunk);
+        allocation.source = Source::Arena;
+        allocation.capacity = size;
+    }
+
+    // Blocks of a class are aligned to their own size, so alignment is covered by rounding up to it
+    size_t blockSize = std::max(size, alignment);
+    if (memory == nullptr && blockSize <= MAX_BLOCK_SIZE)
+    {
+        allocation.sizeClass = static_cast<uint8_t>(sizeClassOf(blockSize));
+        memory = allocateFromPool(allocation.sizeClass);
+        allocation.source = Source::Pool;
+        allocation.capacity = MIN_BLOCK_SIZE << allocation.sizeClass;
+    }
+
+    if (memory == nullptr)
+    {
+        memory = alignedAlloc(size, alignment);
+        allocation.source = Source::System;
+        allocation.capacity = size;
+
+        if (memory != nullptr)
+            systemBytes += size;
+    }
+
+    if (memory == nullptr)
+        return nullptr;
+
+    live.emplace(memory, allocation);
+
+    HostAllocationScopeStats &stats = scopeStats[scopeIndex(scope)];
+    stats.liveCount++;
+    stats.liveBytes += size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+
+    return memory;
+}
+
+void HostAllocator::freeLocked(void *memory)
+{
+    auto existing = live.find(memory);
+    Allocation allocation = existing->second;
+    live.erase(existing);
+
+    HostAllocationScopeStats &stats = scopeStats[scopeIndex(allocation.scope)];
+    stats.liveCount--;
+    stats.liveBytes -= allocation.size;
+
+    switch (allocation.source)
+    {
+        case Source::Pool:
+            *static_cast<void **>(memory) = freeLists[allocation.sizeClass];
+            freeLists[allocation.sizeClass] = memory;
+            break;
+
+        case Source::Arena:
+        {
+            // Whole chunk is rewound once its last allocation is gone
+            ArenaChunk &chunk = arenaChunks[allocation.arenaChunk];
+            if (--chunk.liveCount == 0)
+                chunk.offset = 0;
+            break;
+        }
+
+        case Source::System:
+            systemBytes -= allocation.capacity;
+            alignedFree(memory);
+            break;
+    }
+}
+
+void *HostAllocator::allocateFromPool(size_t sizeClass)
+{
+    if (freeLists[sizeClass] == nullptr)
+    {
+        // Slabs are aligned to largest block size, so every block ends up aligned to its own size
+        char *slab = static_cast<char *>(alignedAlloc(SLAB_SIZE, MAX_BLOCK_SIZE));
+        if (slab == nullptr)
+            return nullptr;
+
+        slabs.push_back(slab);
+
+        size_t blockSize = MIN_BLOCK_SIZE << sizeClass;
+        for (size_t offset = SLAB_SIZE; offset >= blockSize; offset -= blockSize)
+        {
+            void *block = slab + offset - blockSize;
+            *static_cast<void **>(block) = freeLists[sizeClass];
+            freeLists[sizeClass] = block;
+        }
+    }
+
+    void *block = freeLists[sizeClass];
+    freeLists[sizeClass] = *static_cast<void **>(block);
+
+    return block;
+}
+
+void *HostAllocator::allocateFromArena(size_t size, size_t alignment, uint8_t &chunkIndex)
+{
+    auto tryChunk = [&](size_t index) -> void *
+    {
+        ArenaChunk &chunk = arenaChunks[index];
+
+        size_t offset = (chunk.offset + alignment - 1) & ~(alignment - 1);
+        if (offset + size > ARENA_CHUNK_SIZE)
+            return nullptr;
+
+        chunk.offset = offset + size;
+        chunk.liveCount++;
+        chunkIndex = static_cast<uint8_t>(index);
+        currentArenaChunk = index;
+
+        return chunk.memory + offset;
+    };
+
+    if (currentArenaChunk < arenaChunks.size())
+        if (void *memory = tryChunk(currentArenaChunk))
+            return memory;
+
+    for (size_t i = 0; i < arenaChunks.size(); i++)
+        if (arenaChunks[i].liveCount == 0)
+            if (void *memory = tryChunk(i))
+                return memory;
+
+    // Command scope allocations piling up means the driver holds on to them, pools handle that better
+    if (arenaChunks.size() >= MAX_ARENA_CHUNKS)
+        return nullptr;
+
+    ArenaChunk chunk;
+    chunk.memory = static_cast<char *>(alignedAlloc(ARENA_CHUNK_SIZE, MAX_BLOCK_SIZE));
+    if (chunk.memory == nullptr)
+        return nullptr;
+
+    arenaChunks.push_back(chunk);
+
+    return tryChunk(arenaChunks.size() - 1);
+}
+
+VKAPI_ATTR void *VKAPI_CALL HostAllocator::allocationCallback(void *userData, size_t size, size_t alignment,
+                                                              VkSystemAllocationScope scope)
+{
+    return static_cast<HostAllocator *>(userData)->allocate(size, alignment, scope);
+}
+
+VKAPI_ATTR void *VKAPI_CALL HostAllocator::reallocationCallback(void *userData, void *original, size_t size,
+                                                                size_t alignment, VkSystemAllocationScope scope)
+{
+    return static_cast<HostAllocator *>(userData)->reallocate(original, size, alignment, scope);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::freeCallback(void *userData, void *memory)
+{
+    static_cast<HostAllocator *>(userData)->free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::internalAllocationCallback(void *userData, size_t size,
+                                                                     VkInternalAllocationType,
+                                                                     VkSystemAllocationScope scope)
+{
+    auto *allocator = static_cast<HostAllocator *>(userData);
+
+    std::lock_guard<std::mutex> lock(allocator->mutex);
+    allocator->scopeStats[scopeIndex(scope)].internalBytes += size;
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::internalFreeCallback(void *userData, size_t size,
+                                                               VkInternalAllocationType,
+                                                               VkSystemAllocationScope scope)
+{
+    auto *allocator = static_cast<HostAllocator *>(userData);
+
+    std::lock_guard<std::mutex> lock(allocator->mutex);
+    size_t &internalBytes = allocator->scopeStats[scopeIndex(scope)].internalBytes;
+    internalBytes -= std::min(internalBytes, size);
+}
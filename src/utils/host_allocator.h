@@ -0,0 +1,120 @@
+#ifndef HELLO_VULKAN_HOST_ALLOCATOR_H
+#define HELLO_VULKAN_HOST_ALLOCATOR_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+struct HostAllocationScopeStats
+{
+    uint64_t allocations = 0;
+    uint64_t reallocations = 0;
+    uint64_t frees = 0;
+    size_t liveCount = 0;
+    size_t liveBytes = 0;         // requested by driver, not counting rounding to size class
+    size_t peakBytes = 0;
+    size_t internalBytes = 0;     // driver's own allocations, reported through notifications
+};
+
+// Host memory behind VkAllocationCallbacks. Small blocks come from power of two size classes carved out of
+// big slabs, so frequent driver allocations don't hit malloc. Command scope allocations, which only live
+// for the duration of one Vulkan call, are bump allocated from an arena that rewinds once everything in
+// it is freed. Keeps statistics per VkSystemAllocationScope. Thread safe, callbacks may come from any thread.
+class HostAllocator
+{
+    public:
+
+        static const size_t MIN_BLOCK_SIZE = 16;
+        static const size_t MAX_BLOCK_SIZE = 4096;
+        static const size_t SLAB_SIZE = 64 * 1024;
+        static const size_t ARENA_CHUNK_SIZE = 256 * 1024;
+        static const size_t MAX_ARENA_CHUNKS = 4;
+
+        HostAllocator();
+        ~HostAllocator();
+
+        HostAllocator(const HostAllocator &) = delete;
+        HostAllocator &operator=(const HostAllocator &) = delete;
+
+        // Stays valid for the lifetime of allocator, objects must be destroyed with the same callbacks
+        const VkAllocationCallbacks *getCallbacks() const
+        { return &callbacks; }
+
+        HostAllocationScopeStats getScopeStats(VkSystemAllocationScope scope) const;
+
+        void printStats(std::ostream &out) const;
+
+    private:
+
+        enum class Source : uint8_t
+        {
+            Pool,
+            Arena,
+            System
+        };
+
+        struct Allocation
+        {
+            size_t size;
+            size_t capacity;
+            size_t alignment;
+            Source source;
+            uint8_t sizeClass;
+            uint8_t arenaChunk;
+            VkSystemAllocationScope scope;
+        };
+
+        struct ArenaChunk
+        {
+            char *memory = nullptr;
+            size_t offset = 0;
+            size_t liveCount = 0;
+        };
+
+        static const size_t SIZE_CLASS_COUNT = 9;  // 16 B .. 4 KiB
+        static const size_t SCOPE_COUNT = 5;
+
+        VkAllocationCallbacks callbacks{};
+
+        mutable std::mutex mutex;
+
+        std::array<void *, SIZE_CLASS_COUNT> freeLists{};
+        std::vector<void *> slabs;
+        std::vector<ArenaChunk> arenaChunks;
+        size_t currentArenaChunk = 0;
+        size_t systemBytes = 0;
+
+        std::unordered_map<void *, Allocation> live;
+        std::array<HostAllocationScopeStats, SCOPE_COUNT> scopeStats{};
+
+        void *allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void *reallocate(void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void free(void *memory);
+
+        // Following expect mutex to be held
+        void *allocateLocked(size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void freeLocked(void *memory);
+        void *allocateFromPool(size_t sizeClass);
+        void *allocateFromArena(size_t size, size_t alignment, uint8_t &chunkIndex);
+
+        static VKAPI_ATTR void *VKAPI_CALL allocationCallback(void *userData, size_t size, size_t alignment,
+                                                              VkSystemAllocationScope scope);
+        static VKAPI_ATTR void *VKAPI_CALL reallocationCallback(void *userData, void *original, size_t size,
+                                                                size_t alignment, VkSystemAllocationScope scope);
+        static VKAPI_ATTR void VKAPI_CALL freeCallback(void *userData, void *memory);
+        static VKAPI_ATTR void VKAPI_CALL internalAllocationCallback(void *userData, size_t size,
+                                                                     VkInternalAllocationType type,
+                                                                     VkSystemAllocationScope scope);
+        static VKAPI_ATTR void VKAPI_CALL internalFreeCallback(void *userData, size_t size,
+                                                               VkInternalAllocationType type,
+                                                               VkSystemAllocationScope scope);
+};
+
+#endif //HELLO_VULKAN_HOST_ALLOCATOR_H
@@ -1,12 +0,0 @@
-#ifndef HELLO_VULKAN_IO_H
-#define HELLO_VULKAN_IO_H
-
-#include <vector>
-#include <fstream>
-#include <sstream>
-
-using namespace std;
-
-vector<char> readFile(const string& filename);
-
-#endif //HELLO_VULKAN_IO_H
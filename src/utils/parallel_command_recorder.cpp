@@ -0,0 +1,144 @@
+#include "parallel_command_recorder.h"
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+ParallelCommandRecorder::ParallelCommandRecorder(VkDevice device, uint32_t queueFamily, ThreadPool &threadPool,
+                                                 uint32_t framesInFlight, uint32_t maxPartitions,
+                                                 const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks),
+        threadPool(threadPool),
+        maxPartitions(std::max(maxPartitions, 1u))
+{
+    partitions.reserve(framesInFlight * this->maxPartitions);
+
+    for (uint32_t i = 0; i < framesInFlight * this->maxPartitions; i++)
+    {
+        Partition partition{};
+
+        // Pools are reset as a whole, individual buffers never are
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = queueFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        if (vkCreateCommandPool(device, &poolInfo, allocationCallbacks, &partition.commandPool) != VK_SUCCESS)
+            throw std::runtime_error("failed to create recording command pool!");
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = partition.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &partition.commandBuffer) != VK_SUCCESS)
+        {
+            vkDestroyCommandPool(device, partition.commandPool, allocationCallbacks);
+            throw std::runtime_error("failed to allocate secondary command buffer!");
+        }
+
+        partitions.push_back(partition);
+    }
+}
+
+ParallelCommandRecorder::~ParallelCommandRecorder()
+{
+    // Destroying pool frees its command buffers as well
+    for (auto &partition : partitions)
+        vkDestroyCommandPool(device, partition.commandPool, allocationCallbacks);
+}
+
+void ParallelCommandRecorder::record(uint32_t frame, VkCommandBuffer primaryCommandBuffer,
+                                     VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer,
+                                     uint32_t itemCount, const RecordRange &recordRange)
+{
+    uint32_t partitionCount = (itemCount + MIN_ITEMS_PER_PARTITION - 1) / MIN_ITEMS_PER_PARTITION;
+    partitionCount = std::clamp(partitionCount, 1u, maxPartitions);
+
+    Partition *framePartitions = &partitions[frame * maxPartitions];
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = subpass;
+    inheritanceInfo.framebuffer = framebuffer;
+
+    // Spread remainder over first partitions, so sizes differ by one at most
+    uint32_t baseCount = itemCount / partitionCount;
+    uint32_t remainder = itemCount % partitionCount;
+
+    std::vector<std::future<void>> results;
+    results.reserve(partitionCount - 1);
+
+    uint32_t first = baseCount + (remainder > 0 ? 1 : 0);
+    for (uint32_t i = 1; i < partitionCount; i++)
+    {
+        uint32_t count = baseCount + (i < remainder ? 1 : 0);
+        Partition &partition = framePartitions[i];
+
+        results.push_back(threadPool.submit([this, &partition, &inheritanceInfo, first, count, &recordRange]()
+                                            {
+                                                recordPartition(partition, inheritanceInfo, first, count,
+                                                                recordRange);
+                                            }));
+        first += count;
+    }
+
+    // Workers reference locals above, so every one of them has to finish even if some fails
+    std::exception_ptr error;
+    try
+    {
+        recordPartition(framePartitions[0], inheritanceInfo, 0, baseCount + (remainder > 0 ? 1 : 0), recordRange);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    for (auto &result : results)
+    {
+        try
+        {
+            result.get();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+
+    std::vector<VkCommandBuffer> commandBuffers(partitionCount);
+    for (uint32_t i = 0; i < partitionCount; i++)
+        commandBuffers[i] = framePartitions[i].commandBuffer;
+
+    vkCmdExecuteCommands(primaryCommandBuffer, partitionCount, commandBuffers.data());
+}
+
+void ParallelCommandRecorder::recordPartition(Partition &partition,
+                                              const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                                              uint32_t first, uint32_t count, const RecordRange &recordRange)
+{
+    CpuZone zone("record partition");
+
+    vkResetCommandPool(device, partition.commandPool, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(partition.commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+
+    recordRange(partition.commandBuffer, first, count);
+
+    if (vkEndCommandBuffer(partition.commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record secondary command buffer!");
+}
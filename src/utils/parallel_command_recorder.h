@@ -0,0 +1,62 @@
+#ifndef HELLO_VULKAN_PARALLEL_COMMAND_RECORDER_H
+#define HELLO_VULKAN_PARALLEL_COMMAND_RECORDER_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <functional>
+#include <vector>
+
+#include "thread_pool.h"
+
+// Splits recording of a render pass into partitions recorded in parallel into secondary command buffers.
+// Command pools are externally synchronized, so every partition of every frame in flight gets its own pool,
+// which is reset wholesale once GPU is done with that frame. Partition 0 is recorded on calling thread.
+class ParallelCommandRecorder
+{
+    public:
+
+        // Records items [first, first + count) into secondary command buffer, called concurrently
+        using RecordRange = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+        // Splitting is pointless if each partition has only a handful of draws
+        static const uint32_t MIN_ITEMS_PER_PARTITION = 64;
+
+        ParallelCommandRecorder(VkDevice device, uint32_t queueFamily, ThreadPool &threadPool,
+                                uint32_t framesInFlight, uint32_t maxPartitions,
+                                const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~ParallelCommandRecorder();
+
+        ParallelCommandRecorder(const ParallelCommandRecorder &) = delete;
+        ParallelCommandRecorder &operator=(const ParallelCommandRecorder &) = delete;
+
+        // Primary command buffer must be inside render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS,
+        // and previous submission of this frame must be finished
+        void record(uint32_t frame, VkCommandBuffer primaryCommandBuffer,
+                    VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer,
+                    uint32_t itemCount, const RecordRange &recordRange);
+
+        uint32_t getMaxPartitions() const
+        { return maxPartitions; }
+
+    private:
+
+        struct Partition
+        {
+            VkCommandPool commandPool;
+            VkCommandBuffer commandBuffer;
+        };
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+        ThreadPool &threadPool;
+        uint32_t maxPartitions;
+
+        // frame * maxPartitions + partition
+        std::vector<Partition> partitions;
+
+        void recordPartition(Partition &partition, const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                             uint32_t first, uint32_t count, const RecordRange &recordRange);
+};
+
+#endif //HELLO_VULKAN_PARALLEL_COMMAND_RECORDER_H
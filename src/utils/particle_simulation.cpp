@@ -0,0 +1,319 @@
+#include "particle_simulation.h"
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+// Matches push constant block of particles.comp
+struct ParticlePushConstants
+{
+    uint32_t particleCount;
+    float deltaTime;
+};
+
+ParticleSimulation::ParticleSimulation(VkDevice device, DeviceMemoryAllocator &allocator,
+                                       DescriptorLayoutCache &layoutCache, PipelineRegistry &pipelineRegistry,
+                                       VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily,
+                                       uint32_t framesInFlight, const std::vector<Instance> &instances,
+                                       const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocator(allocator),
+        allocationCallbacks(allocationCallbacks),
+        queue(queue),
+        particleCount(static_cast<uint32_t>(instances.size()))
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    setLayout = layoutCache.getLayout(bindings);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ParticlePushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocationCallbacks, &pipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create particle pipeline layout!");
+
+    ComputePipelineDescription description;
+    description.shader = "particles.spv";
+    description.constants.set(0, WORKGROUP_SIZE);
+    description.layout = pipelineLayout;
+
+    pipeline = pipelineRegistry.get(description);
+
+    // One spare state, step for the next frame must not overwrite what the oldest frame in flight reads
+    uint32_t stateCount = framesInFlight + 1;
+    positionBuffers.resize(stateCount);
+    positionMemory.resize(stateCount);
+
+    for (uint32_t i = 0; i < stateCount; i++)
+        positionBuffers[i] = createStateBuffer(sizeof(Instance) * particleCount,
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               queueFamily, graphicsFamily, positionMemory[i]);
+
+    velocityBuffer = createStateBuffer(2 * sizeof(float) * particleCount,
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                       queueFamily, queueFamily, velocityMemory);  // compute queue only
+
+    createDescriptorSets();
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    if (vkCreateCommandPool(device, &poolInfo, allocationCallbacks, &commandPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create particle command pool!");
+
+    commandBuffers.resize(framesInFlight);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = framesInFlight;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate particle command buffers!");
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    finishedSemaphores.resize(framesInFlight);
+    for (auto &semaphore : finishedSemaphores)
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create particle semaphore!");
+
+    upload(instances);
+}
+
+ParticleSimulation::~ParticleSimulation()
+{
+    for (auto semaphore : finishedSemaphores)
+        vkDestroySemaphore(device, semaphore, allocationCallbacks);
+
+    vkDestroyCommandPool(device, commandPool, allocationCallbacks);
+    vkDestroyDescriptorPool(device, descriptorPool, allocationCallbacks);
+
+    for (size_t i = 0; i < positionBuffers.size(); i++)
+        allocator.destroyBuffer(positionBuffers[i], positionMemory[i]);
+    allocator.destroyBuffer(velocityBuffer, velocityMemory);
+
+    vkDestroyPipelineLayout(device, pipelineLayout, allocationCallbacks);
+}
+
+VkSemaphore ParticleSimulation::step(uint32_t frame, float deltaTime, GpuProfiler *profiler)
+{
+    currentState = (currentState + 1) % static_cast<uint32_t>(positionBuffers.size());
+
+    VkCommandBuffer commandBuffer = commandBuffers[frame];
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording particle command buffer!");
+
+    uint32_t scope = UINT32_MAX;
+    if (profiler != nullptr)
+    {
+        profiler->beginFrame(commandBuffer, frame);
+        scope = profiler->beginScope(commandBuffer, "particles");
+    }
+
+    // Velocities are updated in place, previous step on this queue has to be done with them. Also covers
+    // the initial upload.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    ParticlePushConstants pushConstants{};
+    pushConstants.particleCount = particleCount;
+    pushConstants.deltaTime = deltaTime;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &descriptorSets[currentState], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants),
+                       &pushConstants);
+    vkCmdDispatch(commandBuffer, (particleCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    if (profiler != nullptr)
+        profiler->endScope(commandBuffer, scope);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record particle command buffer!");
+
+    // Semaphore makes new positions visible to graphics queue, no fence needed: frame's graphics fence
+    // can't signal before this step is done
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &finishedSemaphores[frame];
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit particle step!");
+
+    stepCount++;
+    return finishedSemaphores[frame];
+}
+
+VkBuffer ParticleSimulation::createStateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, uint32_t queueFamily,
+                                               uint32_t graphicsFamily, DeviceAllocation &allocation)
+{
+    uint32_t queueFamilies[] = {queueFamily, graphicsFamily};
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+
+    if (queueFamily != graphicsFamily)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilies;
+    }
+    else
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    return allocator.createBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocation);
+}
+
+void ParticleSimulation::createDescriptorSets()
+{
+    auto stateCount = static_cast<uint32_t>(positionBuffers.size());
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3 * stateCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = stateCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, allocationCallbacks, &descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create particle descriptor pool!");
+
+    std::vector<VkDescriptorSetLayout> layouts(stateCount, setLayout);
+    descriptorSets.resize(stateCount);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = stateCount;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate particle descriptor sets!");
+
+    // Sets never change, states are rotated by picking a different one
+    for (uint32_t i = 0; i < stateCount; i++)
+    {
+        VkDescriptorBufferInfo bufferInfos[3] =
+                {
+                        {positionBuffers[(i + stateCount - 1) % stateCount], 0, VK_WHOLE_SIZE},
+                        {positionBuffers[i], 0, VK_WHOLE_SIZE},
+                        {velocityBuffer, 0, VK_WHOLE_SIZE}
+                };
+
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t binding = 0; binding < 3; binding++)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = descriptorSets[i];
+            writes[binding].dstBinding = binding;
+            writes[binding].dstArrayElement = 0;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
+        }
+
+        vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+    }
+}
+
+// Done once at startup, so simply waits for the queue
+void ParticleSimulation::upload(const std::vector<Instance> &instances)
+{
+    VkDeviceSize positionsSize = sizeof(Instance) * particleCount;
+    VkDeviceSize velocitiesSize = 2 * sizeof(float) * particleCount;
+
+    // Slow drift in random directions, gravity does the rest
+    std::vector<float> velocities(2 * particleCount);
+    std::minstd_rand random(1);
+    std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+    for (auto &velocity : velocities)
+        velocity = distribution(random);
+
+    VkBufferCreateInfo stagingInfo{};
+    stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingInfo.size = positionsSize + velocitiesSize;
+    stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    DeviceAllocation stagingMemory;
+    VkBuffer stagingBuffer = allocator.createBuffer(stagingInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, stagingMemory);
+
+    auto *mapped = static_cast<char *>(stagingMemory.mapped);
+    memcpy(mapped, instances.data(), positionsSize);
+    memcpy(mapped + positionsSize, velocities.data(), velocitiesSize);
+    allocator.flush(stagingMemory);
+
+    VkCommandBuffer commandBuffer = commandBuffers[0];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording particle upload!");
+
+    VkBufferCopy positionsCopy{0, 0, positionsSize};
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, positionBuffers[currentState], 1, &positionsCopy);
+
+    VkBufferCopy velocitiesCopy{positionsSize, 0, velocitiesSize};
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, velocityBuffer, 1, &velocitiesCopy);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record particle upload!");
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit particle upload!");
+
+    vkQueueWaitIdle(queue);
+
+    allocator.destroyBuffer(stagingBuffer, stagingMemory);
+}
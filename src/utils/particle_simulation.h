@@ -0,0 +1,88 @@
+#ifndef HELLO_VULKAN_PARTICLE_SIMULATION_H
+#define HELLO_VULKAN_PARTICLE_SIMULATION_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+#include "descriptor_layout_cache.h"
+#include "device_memory_allocator.h"
+#include "gpu_profiler.h"
+#include "pipeline_registry.h"
+#include "vertex.h"
+
+// Sample compute workload: instances become particles falling under gravity and bouncing off the edges of
+// instance grid. Every step is its own submission to the compute queue, ideally of a dedicated family, and
+// signals the frame's semaphore which graphics submission waits on before reading placements. Placements are
+// rotated through framesInFlight + 1 buffers, so step N + 1 runs on compute queue while graphics still draws
+// step N, and never overwrites placements some frame in flight is reading.
+class ParticleSimulation
+{
+    public:
+
+        static const uint32_t WORKGROUP_SIZE = 64;
+
+        // Graphics reads placements as instance attributes and, when culling, in compute shader
+        static constexpr VkPipelineStageFlags CONSUMER_STAGES =
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        // Initial state is uploaded and waited for on given queue. Buffers are shared concurrently when queue
+        // family differs from graphics one, so no ownership transfers are needed.
+        ParticleSimulation(VkDevice device, DeviceMemoryAllocator &allocator, DescriptorLayoutCache &layoutCache,
+                           PipelineRegistry &pipelineRegistry, VkQueue queue, uint32_t queueFamily,
+                           uint32_t graphicsFamily, uint32_t framesInFlight, const std::vector<Instance> &instances,
+                           const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~ParticleSimulation();
+
+        ParticleSimulation(const ParticleSimulation &) = delete;
+        ParticleSimulation &operator=(const ParticleSimulation &) = delete;
+
+        // Frame's previous graphics submission has to be finished. Returned semaphore has to be waited on
+        // at CONSUMER_STAGES by graphics submission of the same frame. Profiler has to belong to this queue family.
+        VkSemaphore step(uint32_t frame, float deltaTime, GpuProfiler *profiler = nullptr);
+
+        // Placements written by the last step, in Instance layout
+        VkBuffer getCurrentBuffer() const
+        { return positionBuffers[currentState]; }
+
+        uint64_t getStepCount() const
+        { return stepCount; }
+
+    private:
+
+        VkDevice device;
+        DeviceMemoryAllocator &allocator;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        VkQueue queue;
+        uint32_t particleCount;
+
+        VkDescriptorSetLayout setLayout;  // owned by cache
+        VkPipelineLayout pipelineLayout;
+        VkPipeline pipeline;  // owned by registry
+        VkDescriptorPool descriptorPool;
+
+        // Position buffers are rotated, velocities are only touched by compute queue and updated in place
+        std::vector<VkBuffer> positionBuffers;
+        std::vector<DeviceAllocation> positionMemory;
+        VkBuffer velocityBuffer;
+        DeviceAllocation velocityMemory;
+
+        // Set N reads state N - 1 and writes state N
+        std::vector<VkDescriptorSet> descriptorSets;
+        uint32_t currentState = 0;
+        uint64_t stepCount = 0;
+
+        // Per frame in flight
+        VkCommandPool commandPool;
+        std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<VkSemaphore> finishedSemaphores;
+
+        VkBuffer createStateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, uint32_t queueFamily,
+                                   uint32_t graphicsFamily, DeviceAllocation &allocation);
+        void createDescriptorSets();
+        void upload(const std::vector<Instance> &instances);
+};
+
+#endif //HELLO_VULKAN_PARTICLE_SIMULATION_H
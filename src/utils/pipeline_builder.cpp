@@ -0,0 +1,223 @@
+#include "pipeline_builder.h"
+#include "cpu_profiler.h"
+
+#include <exception>
+#include <future>
+#include <stdexcept>
+
+PipelineBuilder::PipelineBuilder(VkDevice device, const ShaderLibrary &shaderLibrary, VkPipelineCache pipelineCache,
+                                 ThreadPool &threadPool, const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        shaderLibrary(shaderLibrary),
+        pipelineCache(pipelineCache),
+        threadPool(threadPool),
+        allocationCallbacks(allocationCallbacks)
+{
+}
+
+VkPipeline PipelineBuilder::build(const GraphicsPipelineDescription &description) const
+{
+    CpuZone zone("build pipeline");
+
+    VkSpecializationInfo vertexSpecialization = description.vertexConstants.getInfo();
+    VkSpecializationInfo fragmentSpecialization = description.fragmentConstants.getInfo();
+
+    VkPipelineShaderStageCreateInfo shaderStages[] =
+            {
+                    shaderLibrary.getStageInfo(description.vertexShader, "main",
+                                               description.vertexConstants.empty() ? nullptr : &vertexSpecialization),
+                    shaderLibrary.getStageInfo(description.fragmentShader, "main",
+                                               description.fragmentConstants.empty() ? nullptr
+                                                                                     : &fragmentSpecialization)
+            };
+
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(description.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = description.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(description.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = description.vertexAttributes.data();
+
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = description.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+
+    // Actual viewport and scissor are set while recording
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr;
+
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = description.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = description.cullMode;
+    rasterizer.frontFace = description.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+    rasterizer.depthBiasConstantFactor = 0.0f;
+    rasterizer.depthBiasClamp = 0.0f;
+    rasterizer.depthBiasSlopeFactor = 0.0f;
+
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = description.samples;
+    multisampling.minSampleShading = 1.0f;
+    multisampling.pSampleMask = nullptr;
+    multisampling.alphaToCoverageEnable = VK_FALSE;
+    multisampling.alphaToOneEnable = VK_FALSE;
+
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT;
+
+    if (description.blendEnable)
+    {
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    }
+    else
+    {
+        colorBlendAttachment.blendEnable = VK_FALSE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    }
+
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+    colorBlending.blendConstants[0] = 0.0f;
+    colorBlending.blendConstants[1] = 0.0f;
+    colorBlending.blendConstants[2] = 0.0f;
+    colorBlending.blendConstants[3] = 0.0f;
+
+
+    VkDynamicState dynamicStates[] =
+            {
+                    VK_DYNAMIC_STATE_VIEWPORT,
+                    VK_DYNAMIC_STATE_SCISSOR
+            };
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = nullptr;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+
+    pipelineInfo.layout = description.layout;
+    pipelineInfo.renderPass = description.renderPass;
+    pipelineInfo.subpass = description.subpass;
+
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+
+    VkPipeline pipeline;
+
+    VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, allocationCallbacks,
+                                                &pipeline);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create graphics pipeline!");
+
+    return pipeline;
+}
+
+VkPipeline PipelineBuilder::buildCompute(const ComputePipelineDescription &description) const
+{
+    CpuZone zone("build compute pipeline");
+
+    VkSpecializationInfo specialization = description.constants.getInfo();
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderLibrary.getStageInfo(description.shader, "main",
+                                                    description.constants.empty() ? nullptr : &specialization);
+    pipelineInfo.layout = description.layout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    if (pipelineInfo.stage.stage != VK_SHADER_STAGE_COMPUTE_BIT)
+        throw std::runtime_error("shader " + description.shader + " is not a compute shader!");
+
+    VkPipeline pipeline;
+
+    VkResult result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, allocationCallbacks,
+                                               &pipeline);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create compute pipeline!");
+
+    return pipeline;
+}
+
+std::vector<VkPipeline> PipelineBuilder::buildBatch(const std::vector<GraphicsPipelineDescription> &descriptions) const
+{
+    std::vector<std::future<VkPipeline>> compilations;
+    compilations.reserve(descriptions.size());
+
+    for (const auto &description : descriptions)
+        compilations.push_back(threadPool.submit([this, &description]() { return build(description); }));
+
+    std::vector<VkPipeline> pipelines(descriptions.size(), VK_NULL_HANDLE);
+    std::exception_ptr firstError;
+
+    // Waiting for every task even after failure, they reference descriptions owned by caller
+    for (size_t i = 0; i < compilations.size(); i++)
+    {
+        try
+        {
+            pipelines[i] = compilations[i].get();
+        }
+        catch (...)
+        {
+            if (!firstError)
+                firstError = std::current_exception();
+        }
+    }
+
+    if (firstError)
+    {
+        for (auto pipeline : pipelines)
+            if (pipeline != VK_NULL_HANDLE)
+                vkDestroyPipeline(device, pipeline, allocationCallbacks);
+
+        std::rethrow_exception(firstError);
+    }
+
+    return pipelines;
+}
@@ -0,0 +1,80 @@
+#ifndef HELLO_VULKAN_PIPELINE_BUILDER_H
+#define HELLO_VULKAN_PIPELINE_BUILDER_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+
+#include "shader_library.h"
+#include "specialization_constants.h"
+#include "thread_pool.h"
+
+// Everything that varies between our graphics pipelines. Viewport and scissor are dynamic state,
+// so the same pipeline keeps working after swap chain extent changes.
+struct GraphicsPipelineDescription
+{
+    std::string vertexShader = "vert.spv";
+    std::string fragmentShader = "frag.spv";
+
+    // Variant of each shader, pipelines differing only in these are separate pipelines
+    SpecializationConstants vertexConstants;
+    SpecializationConstants fragmentConstants;
+
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    bool blendEnable = false;
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+};
+
+struct ComputePipelineDescription
+{
+    std::string shader;
+    SpecializationConstants constants;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+};
+
+// Compiles graphics and compute pipelines from descriptions. Batches are spread over thread pool:
+// vkCreateGraphicsPipelines is free-threaded, and pipeline cache is internally synchronized, so all workers share
+// one cache.
+class PipelineBuilder
+{
+    public:
+
+        PipelineBuilder(VkDevice device, const ShaderLibrary &shaderLibrary, VkPipelineCache pipelineCache,
+                        ThreadPool &threadPool, const VkAllocationCallbacks *allocationCallbacks = nullptr);
+
+        // Compiles on calling thread
+        VkPipeline build(const GraphicsPipelineDescription &description) const;
+
+        // Compiles on calling thread, shares cache and allocation callbacks with graphics pipelines
+        VkPipeline buildCompute(const ComputePipelineDescription &description) const;
+
+        // Result is in the same order as descriptions. If any pipeline fails, already created ones are destroyed
+        // and the first error is rethrown.
+        std::vector<VkPipeline> buildBatch(const std::vector<GraphicsPipelineDescription> &descriptions) const;
+
+        // Pipelines built here have to be destroyed with these
+        const VkAllocationCallbacks *getAllocationCallbacks() const
+        { return allocationCallbacks; }
+
+    private:
+
+        VkDevice device;
+        const ShaderLibrary &shaderLibrary;
+        VkPipelineCache pipelineCache;
+        ThreadPool &threadPool;
+        const VkAllocationCallbacks *allocationCallbacks;
+};
+
+#endif //HELLO_VULKAN_PIPELINE_BUILDER_H
@@ -0,0 +1,222 @@
+#include "pipeline_registry.h"
+
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
+static void hashCombine(size_t &seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+static uint32_t floorLog2(uint32_t value)
+{
+    uint32_t result = 0;
+    while (value >>= 1)
+        result++;
+
+    return result;
+}
+
+static uint64_t packField(uint32_t value, uint32_t mask, uint32_t shift, const char *name)
+{
+    if ((value & ~mask) != 0)
+        throw std::runtime_error(std::string("pipeline ") + name + " doesn't fit into pipeline state key!");
+
+    return static_cast<uint64_t>(value) << shift;
+}
+
+// Bits: topology 0-3, cull mode 4-5, front face 6, log2 of sample count 7-9, blending 10, polygon mode 32-63.
+// Polygon mode has extension values like VK_POLYGON_MODE_FILL_RECTANGLE_NV, so it keeps the whole upper word,
+// other fields are complete with their bits and anything wider is rejected instead of truncated.
+static uint64_t packFixedState(const GraphicsPipelineDescription &description)
+{
+    uint64_t packed = 0;
+
+    packed |= packField(static_cast<uint32_t>(description.topology), 0xF, 0, "topology");
+    packed |= packField(static_cast<uint32_t>(description.cullMode), 0x3, 4, "cull mode");
+    packed |= packField(static_cast<uint32_t>(description.frontFace), 0x1, 6, "front face");
+    packed |= packField(floorLog2(static_cast<uint32_t>(description.samples)), 0x7, 7, "sample count");
+    packed |= (description.blendEnable ? 1ull : 0ull) << 10;
+    packed |= static_cast<uint64_t>(description.polygonMode) << 32;
+
+    return packed;
+}
+
+static void appendVertexInput(const GraphicsPipelineDescription &description, std::vector<uint32_t> &words)
+{
+    // Counts go first, so bindings can't be confused with attributes
+    words.push_back(static_cast<uint32_t>(description.vertexBindings.size()));
+    words.push_back(static_cast<uint32_t>(description.vertexAttributes.size()));
+
+    for (const auto &binding : description.vertexBindings)
+    {
+        words.push_back(binding.binding);
+        words.push_back(binding.stride);
+        words.push_back(static_cast<uint32_t>(binding.inputRate));
+    }
+
+    for (const auto &attribute : description.vertexAttributes)
+    {
+        words.push_back(attribute.location);
+        words.push_back(attribute.binding);
+        words.push_back(static_cast<uint32_t>(attribute.format));
+        words.push_back(attribute.offset);
+    }
+}
+
+static uint64_t hashWords(const std::vector<uint32_t> &words)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (uint32_t word : words)
+    {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+size_t PipelineStateKeyHash::operator()(const PipelineStateKey &key) const
+{
+    size_t hash = std::hash<VkRenderPass>{}(key.renderPass);
+
+    hashCombine(hash, std::hash<VkPipelineLayout>{}(key.layout));
+    hashCombine(hash, std::hash<uint32_t>{}(key.vertexShader));
+    hashCombine(hash, std::hash<uint32_t>{}(key.fragmentShader));
+    hashCombine(hash, std::hash<uint64_t>{}(key.fixedState));
+    hashCombine(hash, std::hash<uint32_t>{}(key.subpass));
+    hashCombine(hash, std::hash<uint64_t>{}(key.variableStateHash));
+
+    return hash;
+}
+
+PipelineRegistry::PipelineRegistry(VkDevice device, const ShaderLibrary &shaderLibrary, const PipelineBuilder &builder) :
+        device(device),
+        shaderLibrary(shaderLibrary),
+        builder(builder)
+{
+}
+
+PipelineRegistry::~PipelineRegistry()
+{
+    for (auto &entry : pipelines)
+        vkDestroyPipeline(device, entry.second, builder.getAllocationCallbacks());
+}
+
+PipelineStateKey PipelineRegistry::makeKey(const GraphicsPipelineDescription &description) const
+{
+    PipelineStateKey key{};
+    key.renderPass = description.renderPass;
+    key.layout = description.layout;
+    key.vertexShader = shaderLibrary.get(description.vertexShader).id;
+    key.fragmentShader = shaderLibrary.get(description.fragmentShader).id;
+    key.fixedState = packFixedState(description);
+    key.subpass = description.subpass;
+
+    // Stages keep their order, so the same values in vertex or fragment stage give different keys
+    appendVertexInput(description, key.variableState);
+    description.vertexConstants.appendWords(key.variableState);
+    description.fragmentConstants.appendWords(key.variableState);
+    key.variableStateHash = hashWords(key.variableState);
+
+    return key;
+}
+
+PipelineStateKey PipelineRegistry::makeKey(const ComputePipelineDescription &description) const
+{
+    PipelineStateKey key{};
+    key.renderPass = VK_NULL_HANDLE;
+    key.layout = description.layout;
+    key.vertexShader = shaderLibrary.get(description.shader).id;
+    key.fragmentShader = UINT32_MAX;
+    key.fixedState = COMPUTE_PIPELINE_STATE;
+    description.constants.appendWords(key.variableState);
+    key.variableStateHash = hashWords(key.variableState);
+
+    return key;
+}
+
+VkPipeline PipelineRegistry::get(const GraphicsPipelineDescription &description)
+{
+    PipelineStateKey key = makeKey(description);
+
+    VkPipeline pipeline = find(key);
+    if (pipeline != VK_NULL_HANDLE)
+        return pipeline;
+
+    // Compiling without lock, other threads keep getting their cached pipelines meanwhile
+    misses++;
+    return insert(key, builder.build(description));
+}
+
+VkPipeline PipelineRegistry::get(const ComputePipelineDescription &description)
+{
+    PipelineStateKey key = makeKey(description);
+
+    VkPipeline pipeline = find(key);
+    if (pipeline != VK_NULL_HANDLE)
+        return pipeline;
+
+    misses++;
+    return insert(key, builder.buildCompute(description));
+}
+
+void PipelineRegistry::prewarm(const std::vector<GraphicsPipelineDescription> &descriptions)
+{
+    std::vector<GraphicsPipelineDescription> missing;
+    std::vector<PipelineStateKey> missingKeys;
+    std::unordered_set<PipelineStateKey, PipelineStateKeyHash> queued;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        for (const auto &description : descriptions)
+        {
+            PipelineStateKey key = makeKey(description);
+
+            if (pipelines.count(key) == 0 && queued.insert(key).second)
+            {
+                missing.push_back(description);
+                missingKeys.push_back(key);
+            }
+        }
+    }
+
+    std::vector<VkPipeline> compiled = builder.buildBatch(missing);
+
+    misses += compiled.size();
+    for (size_t i = 0; i < compiled.size(); i++)
+        insert(missingKeys[i], compiled[i]);
+}
+
+size_t PipelineRegistry::getPipelineCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return pipelines.size();
+}
+
+VkPipeline PipelineRegistry::find(const PipelineStateKey &key)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    auto found = pipelines.find(key);
+    if (found == pipelines.end())
+        return VK_NULL_HANDLE;
+
+    hits++;
+    return found->second;
+}
+
+VkPipeline PipelineRegistry::insert(const PipelineStateKey &key, VkPipeline pipeline)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    auto inserted = pipelines.emplace(key, pipeline);
+    if (!inserted.second)
+        vkDestroyPipeline(device, pipeline, builder.getAllocationCallbacks());
+
+    return inserted.first->second;
+}
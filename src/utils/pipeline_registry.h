@@ -0,0 +1,103 @@
+#ifndef HELLO_VULKAN_PIPELINE_REGISTRY_H
+#define HELLO_VULKAN_PIPELINE_REGISTRY_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "pipeline_builder.h"
+#include "shader_library.h"
+
+// Compact identity of a graphics pipeline: shader module ids instead of names and all fixed function state packed
+// into one word, so hashing and comparing is mostly a handful of integer operations. Compute pipelines use the same
+// key with their shader in place of vertex shader and COMPUTE_PIPELINE_STATE as fixed state.
+struct PipelineStateKey
+{
+    VkRenderPass renderPass;
+    VkPipelineLayout layout;
+
+    uint32_t vertexShader;
+    uint32_t fragmentShader;
+    uint64_t fixedState;
+    uint32_t subpass;
+
+    // Vertex input layout and specialization constants of all stages as canonical words. Their hash rejects
+    // most unequal keys cheaply, the words themselves decide equality, so colliding hashes never share a pipeline.
+    uint64_t variableStateHash;
+    std::vector<uint32_t> variableState;
+
+    bool operator==(const PipelineStateKey &other) const
+    {
+        return
+                renderPass == other.renderPass &&
+                layout == other.layout &&
+                vertexShader == other.vertexShader &&
+                fragmentShader == other.fragmentShader &&
+                fixedState == other.fixedState &&
+                subpass == other.subpass &&
+                variableStateHash == other.variableStateHash &&
+                variableState == other.variableState;
+    }
+};
+
+// Outside of bits packed for graphics pipelines, so compute and graphics keys never compare equal
+const uint64_t COMPUTE_PIPELINE_STATE = 0x80000000u;
+
+struct PipelineStateKeyHash
+{
+    size_t operator()(const PipelineStateKey &key) const;
+};
+
+// Creates pipelines on first request and hands out the same VkPipeline for every later request with equal state.
+// Safe to use from several threads, owns all pipelines it returns.
+class PipelineRegistry
+{
+    public:
+
+        PipelineRegistry(VkDevice device, const ShaderLibrary &shaderLibrary, const PipelineBuilder &builder);
+        ~PipelineRegistry();
+
+        PipelineRegistry(const PipelineRegistry &) = delete;
+        PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+
+        PipelineStateKey makeKey(const GraphicsPipelineDescription &description) const;
+        PipelineStateKey makeKey(const ComputePipelineDescription &description) const;
+
+        VkPipeline get(const GraphicsPipelineDescription &description);
+        VkPipeline get(const ComputePipelineDescription &description);
+
+        // Compiles all missing pipelines at once in parallel, e.g. during loading screen
+        void prewarm(const std::vector<GraphicsPipelineDescription> &descriptions);
+
+        size_t getPipelineCount() const;
+
+        uint64_t getHitCount() const
+        { return hits; }
+
+        uint64_t getMissCount() const
+        { return misses; }
+
+    private:
+
+        VkDevice device;
+        const ShaderLibrary &shaderLibrary;
+        const PipelineBuilder &builder;
+
+        mutable std::shared_mutex mutex;
+        std::unordered_map<PipelineStateKey, VkPipeline, PipelineStateKeyHash> pipelines;
+
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+
+        // Counts a hit when pipeline is there, VK_NULL_HANDLE otherwise
+        VkPipeline find(const PipelineStateKey &key);
+
+        // Returns pipeline stored under key, destroying ours if another thread was faster
+        VkPipeline insert(const PipelineStateKey &key, VkPipeline pipeline);
+};
+
+#endif //HELLO_VULKAN_PIPELINE_REGISTRY_H
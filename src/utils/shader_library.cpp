@@ -0,0 +1,236 @@
+#include "shader_library.h"
+#include "spirv_blob.h"
+#include "embedded_shaders.h"
+#include "cpu_profiler.h"
+
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+static uint64_t hashContent(const uint32_t *words, size_t byteSize)
+{
+    // FNV-1a, plenty for telling shader binaries apart
+    uint64_t hash = 14695981039346656037ull;
+
+    const auto *bytes = reinterpret_cast<const uint8_t *>(words);
+    for (size_t i = 0; i < byteSize; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static VkShaderStageFlagBits toShaderStage(uint32_t executionModel)
+{
+    switch (executionModel)
+    {
+        case 0:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1:
+            return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2:
+            return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3:
+            return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+        default:
+            return VK_SHADER_STAGE_ALL;
+    }
+}
+
+static std::vector<ShaderEntryPoint> reflectEntryPoints(const uint32_t *words, size_t wordCount)
+{
+    const uint32_t OP_ENTRY_POINT = 15;
+    const uint32_t OP_FUNCTION = 54;
+    const size_t HEADER_WORDS = 5;
+
+    std::vector<ShaderEntryPoint> entryPoints;
+
+    size_t position = HEADER_WORDS;
+    while (position < wordCount)
+    {
+        uint32_t instructionWordCount = words[position] >> 16;
+        uint32_t opcode = words[position] & 0xFFFF;
+
+        if (instructionWordCount == 0 || position + instructionWordCount > wordCount)
+            break;
+
+        // Logical layout puts entry points before any function, no need to walk the whole module
+        if (opcode == OP_FUNCTION)
+            break;
+
+        // OpEntryPoint: execution model, function id, null terminated name, interface ids
+        if (opcode == OP_ENTRY_POINT && instructionWordCount >= 4)
+        {
+            const char *name = reinterpret_cast<const char *>(&words[position + 3]);
+            size_t maxLength = (instructionWordCount - 3) * sizeof(uint32_t);
+
+            ShaderEntryPoint entryPoint;
+            entryPoint.name = std::string(name, strnlen(name, maxLength));
+            entryPoint.stage = toShaderStage(words[position + 1]);
+            entryPoints.push_back(entryPoint);
+        }
+
+        position += instructionWordCount;
+    }
+
+    return entryPoints;
+}
+
+ShaderLibrary::ShaderLibrary(VkDevice device, const VkAllocationCallbacks *allocationCallbacks) :
+        device(device),
+        allocationCallbacks(allocationCallbacks)
+{
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+    for (auto &module : modules)
+        vkDestroyShaderModule(device, module.second.module, allocationCallbacks);
+}
+
+size_t ShaderLibrary::loadDirectory(const std::string &directory)
+{
+    size_t fileCount = 0;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".spv")
+            continue;
+
+        load(entry.path().string());
+        fileCount++;
+    }
+
+    return fileCount;
+}
+
+const ShaderModuleInfo &ShaderLibrary::load(const std::string &path)
+{
+    CpuZone zone("load shader");
+
+    std::string name = std::filesystem::path(path).filename().string();
+
+    auto registered = modulesByName.find(name);
+    if (registered != modulesByName.end())
+        return *registered->second;
+
+    SpirvBlob code(path);
+
+    return registerCode(name, code.code(), code.size());
+}
+
+size_t ShaderLibrary::loadEmbedded()
+{
+    CpuZone zone("load embedded shaders");
+
+    size_t shaderCount = 0;
+
+    for (const EmbeddedShader *shader = EMBEDDED_SHADERS; shader->name != nullptr; shader++)
+    {
+        if (contains(shader->name))
+            continue;
+
+        // Validated at build time already, this only catches a broken generator
+        if (shader->size < sizeof(uint32_t) || shader->size % sizeof(uint32_t) != 0 ||
+            shader->code[0] != SpirvBlob::MAGIC_NUMBER)
+        {
+            std::stringstream error_message;
+            error_message << "embedded shader " << shader->name << " is not valid SPIR-V!";
+            throw std::runtime_error(error_message.str());
+        }
+
+        registerCode(shader->name, shader->code, shader->size);
+        shaderCount++;
+    }
+
+    return shaderCount;
+}
+
+const ShaderModuleInfo &ShaderLibrary::registerCode(const std::string &name, const uint32_t *code, size_t size)
+{
+    uint64_t contentHash = hashContent(code, size);
+
+    std::stringstream contentKey;
+    contentKey << std::hex << contentHash << ":" << size;
+
+    auto candidates = modules.equal_range(contentKey.str());
+    for (auto existing = candidates.first; existing != candidates.second; existing++)
+    {
+        if (std::memcmp(existing->second.code.data(), code, size) == 0)
+        {
+            modulesByName[name] = &existing->second;
+            return existing->second;
+        }
+    }
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = size;
+    createInfo.pCode = code;
+
+    ShaderModuleInfo info{};
+    info.id = static_cast<uint32_t>(modules.size());
+    info.contentHash = contentHash;
+    info.codeSize = size;
+    info.code.assign(code, code + size / sizeof(uint32_t));
+    info.entryPoints = reflectEntryPoints(code, size / sizeof(uint32_t));
+
+    VkResult result = vkCreateShaderModule(device, &createInfo, allocationCallbacks, &info.module);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create shader module!");
+
+    const ShaderModuleInfo &stored = modules.emplace(contentKey.str(), std::move(info))->second;
+    modulesByName[name] = &stored;
+
+    return stored;
+}
+
+const ShaderModuleInfo &ShaderLibrary::get(const std::string &name) const
+{
+    auto registered = modulesByName.find(name);
+    if (registered == modulesByName.end())
+    {
+        std::stringstream error_message;
+        error_message << "shader " << name << " is not loaded!";
+        throw std::runtime_error(error_message.str());
+    }
+
+    return *registered->second;
+}
+
+bool ShaderLibrary::contains(const std::string &name) const
+{
+    return modulesByName.count(name) != 0;
+}
+
+VkPipelineShaderStageCreateInfo ShaderLibrary::getStageInfo(const std::string &name, const char *entryPoint,
+                                                            const VkSpecializationInfo *specialization) const
+{
+    const ShaderModuleInfo &info = get(name);
+
+    for (const auto &reflected : info.entryPoints)
+    {
+        if (reflected.name != entryPoint)
+            continue;
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = reflected.stage;
+        stageInfo.module = info.module;
+        stageInfo.pName = reflected.name.c_str();
+        stageInfo.pSpecializationInfo = specialization;
+
+        return stageInfo;
+    }
+
+    std::stringstream error_message;
+    error_message << "shader " << name << " has no entry point " << entryPoint << "!";
+    throw std::runtime_error(error_message.str());
+}
@@ -0,0 +1,83 @@
+#ifndef HELLO_VULKAN_SHADER_LIBRARY_H
+#define HELLO_VULKAN_SHADER_LIBRARY_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct ShaderEntryPoint
+{
+    std::string name;
+    VkShaderStageFlagBits stage;
+};
+
+struct ShaderModuleInfo
+{
+    // Small dense number, identical for files sharing a module
+    uint32_t id;
+
+    VkShaderModule module;
+    uint64_t contentHash;
+    size_t codeSize;
+
+    // Copy of SPIR-V, so files are only shared when their bytes are identical, not just their hashes
+    std::vector<uint32_t> code;
+
+    // Reflected from OpEntryPoint instructions
+    std::vector<ShaderEntryPoint> entryPoints;
+};
+
+// Owns every VkShaderModule of the application. Modules are looked up by file name (e.g. "vert.spv"), stay alive
+// until library is destroyed, and files with identical content share one module. Shaders embedded into the binary
+// are registered under the same names, whichever source registers a name first wins.
+class ShaderLibrary
+{
+    public:
+
+        explicit ShaderLibrary(VkDevice device, const VkAllocationCallbacks *allocationCallbacks = nullptr);
+        ~ShaderLibrary();
+
+        ShaderLibrary(const ShaderLibrary &) = delete;
+        ShaderLibrary &operator=(const ShaderLibrary &) = delete;
+
+        // Registers all *.spv files of directory, returns amount of files found
+        size_t loadDirectory(const std::string &directory);
+
+        // Registers single file under its file name, already registered names are not read again
+        const ShaderModuleInfo &load(const std::string &path);
+
+        // Registers every shader compiled into the binary whose name isn't registered yet, no file I/O.
+        // Returns amount of shaders registered.
+        size_t loadEmbedded();
+
+        const ShaderModuleInfo &get(const std::string &name) const;
+
+        bool contains(const std::string &name) const;
+
+        // Stage description for pipeline creation, stage itself is taken from reflected entry point.
+        // Specialization info is only referenced, it has to outlive pipeline creation.
+        VkPipelineShaderStageCreateInfo getStageInfo(const std::string &name, const char *entryPoint = "main",
+                                                     const VkSpecializationInfo *specialization = nullptr) const;
+
+        size_t getFileCount() const
+        { return modulesByName.size(); }
+
+        size_t getModuleCount() const
+        { return modules.size(); }
+
+    private:
+
+        VkDevice device;
+        const VkAllocationCallbacks *allocationCallbacks;
+
+        // Values are never erased, so references handed out stay valid. Colliding contents share a key.
+        std::unordered_multimap<std::string, ShaderModuleInfo> modules;  // by "hash:size" content key
+        std::unordered_map<std::string, const ShaderModuleInfo *> modulesByName;
+
+        const ShaderModuleInfo &registerCode(const std::string &name, const uint32_t *code, size_t size);
+};
+
+#endif //HELLO_VULKAN_SHADER_LIBRARY_H
@@ -0,0 +1,71 @@
+#include "specialization_constants.h"
+
+#include <algorithm>
+#include <cstring>
+
+SpecializationConstants &SpecializationConstants::set(uint32_t id, bool value)
+{
+    return setBits(id, value ? VK_TRUE : VK_FALSE);
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t id, uint32_t value)
+{
+    return setBits(id, value);
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t id, int32_t value)
+{
+    return setBits(id, static_cast<uint32_t>(value));
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t id, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    return setBits(id, bits);
+}
+
+void SpecializationConstants::appendWords(std::vector<uint32_t> &words) const
+{
+    words.push_back(static_cast<uint32_t>(ids.size()));
+
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        words.push_back(ids[i]);
+        words.push_back(values[i]);
+    }
+}
+
+VkSpecializationInfo SpecializationConstants::getInfo() const
+{
+    VkSpecializationInfo info{};
+    info.mapEntryCount = static_cast<uint32_t>(entries.size());
+    info.pMapEntries = entries.data();
+    info.dataSize = values.size() * sizeof(uint32_t);
+    info.pData = values.data();
+
+    return info;
+}
+
+SpecializationConstants &SpecializationConstants::setBits(uint32_t id, uint32_t bits)
+{
+    auto position = std::lower_bound(ids.begin(), ids.end(), id);
+    auto index = static_cast<size_t>(position - ids.begin());
+
+    if (position != ids.end() && *position == id)
+    {
+        values[index] = bits;
+        return *this;
+    }
+
+    ids.insert(position, id);
+    values.insert(values.begin() + static_cast<std::ptrdiff_t>(index), bits);
+
+    // Offsets follow sorted order, so all entries are rebuilt
+    entries.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+        entries[i] = {ids[i], static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t)};
+
+    return *this;
+}
@@ -0,0 +1,47 @@
+#ifndef HELLO_VULKAN_SPECIALIZATION_CONSTANTS_H
+#define HELLO_VULKAN_SPECIALIZATION_CONSTANTS_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <vector>
+
+// Values for specialization constants of one shader stage, by constant_id. One SPIR-V module specialized with
+// different values gives separate pipelines in which driver folds constants like any literal, so feature toggles
+// drop dead branches and loop counts or workgroup sizes are known at compile time. Every constant is 32 bits:
+// bools are stored as VkBool32, ints and floats by their bit pattern.
+class SpecializationConstants
+{
+    public:
+
+        // Setting the same id again replaces its value
+        SpecializationConstants &set(uint32_t id, bool value);
+        SpecializationConstants &set(uint32_t id, uint32_t value);
+        SpecializationConstants &set(uint32_t id, int32_t value);
+        SpecializationConstants &set(uint32_t id, float value);
+
+        bool empty() const
+        { return entries.empty(); }
+
+        // Canonical form for keying pipelines: constant count, then id and value of each constant by id, so it
+        // doesn't depend on order values were set in
+        void appendWords(std::vector<uint32_t> &words) const;
+
+        bool operator==(const SpecializationConstants &other) const
+        { return ids == other.ids && values == other.values; }
+
+        // Points into this object, which has to stay alive and unchanged until pipeline is created
+        VkSpecializationInfo getInfo() const;
+
+    private:
+
+        // Kept sorted by id, values[i] belongs to ids[i]
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> values;
+        std::vector<VkSpecializationMapEntry> entries;
+
+        SpecializationConstants &setBits(uint32_t id, uint32_t bits);
+};
+
+#endif //HELLO_VULKAN_SPECIALIZATION_CONSTANTS_H
@@ -0,0 +1,200 @@
+#include "spirv_blob.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Magic number and four more header words: version, generator, bound, schema
+static const size_t SPIRV_HEADER_SIZE = 5 * sizeof(uint32_t);
+
+SpirvBlob::SpirvBlob(const std::string &filename)
+{
+    if (!map(filename))
+        stream(filename);
+
+    try
+    {
+        validate(filename);
+    }
+    catch (...)
+    {
+        // Destructor is not called for partially constructed object
+        release();
+        throw;
+    }
+}
+
+SpirvBlob::~SpirvBlob()
+{
+    release();
+}
+
+SpirvBlob::SpirvBlob(SpirvBlob &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+SpirvBlob &SpirvBlob::operator=(SpirvBlob &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    release();
+
+    // Moving vector keeps its heap buffer, so pointer into it stays valid
+    streamedWords = std::move(other.streamedWords);
+    words = other.words;
+    byteSize = other.byteSize;
+    mappedView = other.mappedView;
+#ifdef _WIN32
+    fileHandle = other.fileHandle;
+    mappingHandle = other.mappingHandle;
+    other.fileHandle = nullptr;
+    other.mappingHandle = nullptr;
+#endif
+
+    other.words = nullptr;
+    other.byteSize = 0;
+    other.mappedView = nullptr;
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool SpirvBlob::map(const std::string &filename)
+{
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedView = view;
+    words = static_cast<const uint32_t *>(view);
+    byteSize = static_cast<size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+#else
+
+bool SpirvBlob::map(const std::string &filename)
+{
+    int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat fileStat{};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // Mapping holds its own reference to the file
+    close(file);
+
+    if (view == MAP_FAILED)
+        return false;
+
+    mappedView = view;
+    words = static_cast<const uint32_t *>(view);
+    byteSize = static_cast<size_t>(fileStat.st_size);
+
+    return true;
+}
+
+#endif
+
+void SpirvBlob::stream(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open())
+    {
+        std::stringstream error_message;
+        error_message << "failed to open file " << filename << "!";
+        throw std::runtime_error(error_message.str());
+    }
+
+    byteSize = (size_t) file.tellg();
+    streamedWords.resize((byteSize + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(streamedWords.data()), byteSize);
+
+    words = streamedWords.data();
+}
+
+void SpirvBlob::validate(const std::string &filename) const
+{
+    std::stringstream error_message;
+
+    if (byteSize < SPIRV_HEADER_SIZE || byteSize % sizeof(uint32_t) != 0)
+        error_message << "invalid SPIR-V size " << byteSize << " bytes in " << filename << "!";
+    else if (words[0] != MAGIC_NUMBER)
+        error_message << "invalid SPIR-V magic number in " << filename << "!";
+    else
+        return;
+
+    throw std::runtime_error(error_message.str());
+}
+
+void SpirvBlob::release()
+{
+    if (mappedView != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mappedView);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(mappedView, byteSize);
+#endif
+        mappedView = nullptr;
+    }
+
+    streamedWords.clear();
+    words = nullptr;
+    byteSize = 0;
+}
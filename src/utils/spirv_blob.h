@@ -0,0 +1,55 @@
+#ifndef HELLO_VULKAN_SPIRV_BLOB_H
+#define HELLO_VULKAN_SPIRV_BLOB_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only SPIR-V binary, ready to be passed to vkCreateShaderModule as is.
+// File is memory mapped when possible (no allocation, no copy, page aligned), otherwise it is streamed into
+// uint32_t storage, so code() is always properly aligned. Magic number and size are validated on load.
+class SpirvBlob
+{
+    public:
+
+        static const uint32_t MAGIC_NUMBER = 0x07230203;
+
+        explicit SpirvBlob(const std::string &filename);
+        ~SpirvBlob();
+
+        SpirvBlob(SpirvBlob &&other) noexcept;
+        SpirvBlob &operator=(SpirvBlob &&other) noexcept;
+
+        SpirvBlob(const SpirvBlob &) = delete;
+        SpirvBlob &operator=(const SpirvBlob &) = delete;
+
+        const uint32_t *code() const
+        { return words; }
+
+        // In bytes, as VkShaderModuleCreateInfo::codeSize expects
+        size_t size() const
+        { return byteSize; }
+
+        bool isMapped() const
+        { return mappedView != nullptr; }
+
+    private:
+
+        const uint32_t *words = nullptr;
+        size_t byteSize = 0;
+
+        void *mappedView = nullptr;
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+        std::vector<uint32_t> streamedWords;
+
+        bool map(const std::string &filename);
+        void stream(const std::string &filename);
+        void validate(const std::string &filename) const;
+        void release();
+};
+
+#endif //HELLO_VULKAN_SPIRV_BLOB_H
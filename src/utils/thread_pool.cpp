@@ -0,0 +1,51 @@
+#include "thread_pool.h"
+#include "cpu_profiler.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+
+    // Tasks already queued are still executed, so nobody waits on a future forever
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    CpuProfiler::setThreadName("worker " + std::to_string(index));
+
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+    }
+}
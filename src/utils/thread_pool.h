@@ -0,0 +1,60 @@
+#ifndef HELLO_VULKAN_THREAD_POOL_H
+#define HELLO_VULKAN_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads consuming one shared FIFO of tasks
+class ThreadPool
+{
+    public:
+
+        // Zero means one worker per hardware thread
+        explicit ThreadPool(size_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Exceptions thrown by task are delivered through returned future
+        template<typename Task>
+        std::future<std::invoke_result_t<Task>> submit(Task task)
+        {
+            using Result = std::invoke_result_t<Task>;
+
+            // std::function needs copyable callable, packaged_task is move-only
+            auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+            std::future<Result> result = packagedTask->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace([packagedTask]() { (*packagedTask)(); });
+            }
+
+            condition.notify_one();
+            return result;
+        }
+
+        size_t getThreadCount() const
+        { return workers.size(); }
+
+    private:
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+
+        void workerLoop(size_t index);
+};
+
+#endif //HELLO_VULKAN_THREAD_POOL_H
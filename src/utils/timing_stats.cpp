@@ -0,0 +1,29 @@
+#include "timing_stats.h"
+
+#include <algorithm>
+#include <numeric>
+
+TimingStats computeTimingStats(std::vector<double> samples)
+{
+    TimingStats stats;
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+
+    // Nearest rank: smallest sample with at least percent of samples at or below it. Integer math, so ranks
+    // like 99 of 100 don't round up to the maximum.
+    auto percentile = [&samples](size_t percent)
+    {
+        size_t rank = (percent * samples.size() + 99) / 100;
+        return samples[std::max<size_t>(rank, 1) - 1];
+    };
+
+    stats.count = samples.size();
+    stats.average = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.p50 = percentile(50);
+    stats.p99 = percentile(99);
+    stats.max = samples.back();
+
+    return stats;
+}
@@ -0,0 +1,19 @@
+#ifndef HELLO_VULKAN_TIMING_STATS_H
+#define HELLO_VULKAN_TIMING_STATS_H
+
+#include <cstddef>
+#include <vector>
+
+struct TimingStats
+{
+    size_t count = 0;
+    double average = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Nearest-rank percentiles, all zeros for empty input
+TimingStats computeTimingStats(std::vector<double> samples);
+
+#endif //HELLO_VULKAN_TIMING_STATS_H
@@ -0,0 +1,83 @@
+#include "vk_pipeline_cache.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE header, see "Pipeline Cache" chapter of the spec
+struct PipelineCacheHeader
+{
+    uint32_t headerSize;
+    uint32_t headerVersion;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+std::vector<char> loadPipelineCacheData(const std::string &filename, const VkPhysicalDeviceProperties &deviceProperties)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open())
+        return {};
+
+    size_t fileSize = (size_t) file.tellg();
+    std::vector<char> data(fileSize);
+
+    file.seekg(0);
+    file.read(data.data(), fileSize);
+
+    if (!file || fileSize < sizeof(PipelineCacheHeader))
+    {
+        std::cout << "Pipeline cache " << filename << " is truncated, ignoring it" << std::endl;
+        return {};
+    }
+
+    PipelineCacheHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+
+    bool compatible =
+            header.headerSize >= sizeof(PipelineCacheHeader) &&
+            header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == deviceProperties.vendorID &&
+            header.deviceID == deviceProperties.deviceID &&
+            memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+    if (!compatible)
+    {
+        std::cout << "Pipeline cache " << filename << " was created by another device or driver, ignoring it"
+                  << std::endl;
+        return {};
+    }
+
+    return data;
+}
+
+void savePipelineCacheData(const std::string &filename, VkDevice device, VkPipelineCache pipelineCache)
+{
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
+
+    // Writing next to target and renaming, so crash in the middle never leaves half-written cache behind
+    std::string temporaryFilename = filename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), dataSize);
+
+        if (!file)
+        {
+            std::cerr << "failed to write pipeline cache " << temporaryFilename << "!" << std::endl;
+            return;
+        }
+    }
+
+    std::remove(filename.c_str());
+    if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+        std::cerr << "failed to replace pipeline cache " << filename << "!" << std::endl;
+}
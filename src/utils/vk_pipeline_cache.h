@@ -0,0 +1,16 @@
+#ifndef HELLO_VULKAN_VK_PIPELINE_CACHE_H
+#define HELLO_VULKAN_VK_PIPELINE_CACHE_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+
+// Returns cache blob saved by previous run, or empty data if file is missing, corrupted or was produced by another
+// device/driver. Driver would reject foreign data anyway, but checking header ourselves makes cold start explicit.
+std::vector<char> loadPipelineCacheData(const std::string &filename, const VkPhysicalDeviceProperties &deviceProperties);
+
+void savePipelineCacheData(const std::string &filename, VkDevice device, VkPipelineCache pipelineCache);
+
+#endif //HELLO_VULKAN_VK_PIPELINE_CACHE_H